@@ -0,0 +1,32 @@
+#ifndef YASL_BYTECODE_H_
+#define YASL_BYTECODE_H_
+
+/*
+ * Layout of bytecode files, as written by YASL_savebytecode and read by YASL_newstate_bytecode. require uses the same
+ * layout for its cache of compiled modules:
+ *
+ *   4 bytes    YASL_BYTECODE_MAGIC
+ *   1 byte     YASL_BYTECODE_VERSION
+ *   1 byte     sizeof(yasl_int)
+ *   1 byte     sizeof(yasl_float)
+ *   1 byte     reserved, always 0
+ *   8 bytes    YASL_BYTECODE_ENDIAN_CHECK, as a native int64_t
+ *   8 bytes    length of the program, as a native int64_t
+ *   8 bytes    hash of the source the program was compiled from, or 0 if it is not a cached module
+ *   program    exactly as returned by compile(): header with the constant table, code, O_HALT, then line numbers
+ *
+ * Everything in the program is addressed relative to its start, so it can be loaded anywhere. Files are mapped into
+ * memory read-only and run in place, with string constants pointing into the mapping; the program starts 8-byte
+ * aligned within the page-aligned mapping. Numbers are stored in native byte order, so files only load on machines
+ * that agree with the writer on byte order and type sizes.
+ *
+ * YASL_BYTECODE_VERSION must be bumped whenever the program layout or the meaning of an opcode changes.
+ */
+
+#define YASL_BYTECODE_MAGIC "\x1bYSL"
+#define YASL_BYTECODE_MAGIC_LEN 4
+#define YASL_BYTECODE_VERSION 3
+#define YASL_BYTECODE_ENDIAN_CHECK ((int64_t)0x0102030405060708)
+#define YASL_BYTECODE_FILE_HEADER_LEN 32
+
+#endif
@@ -7,6 +7,7 @@ enum Opcode {
 	O_BCONST_T = 0x09, // push literal true onto stack
 	O_FCONST = 0x0A, // push function literal onto stack
 	O_CCONST = 0x0B, // push closure literal onto stack
+	O_LAZY = 0x0C, // compile the rest of the function on its first call, then branch to it
 
 	O_HALT = 0x0F, // halt
 
@@ -35,6 +36,7 @@ enum Opcode {
 	O_NOT = 0x69, // negate a boolean
 	O_LEN = 0x6A, // get length
 	O_CNCT = 0x6B, // concat two strings or lists
+	O_CNCT_N = 0x6C, // stringify the top n values and concat them (n: 1 byte)
 
 	O_LT = 0x70, // less than
 	O_LE = 0x71, // less than or equal
@@ -3,54 +3,18 @@
 #include <stdarg.h>
 
 #include "common/debug.h"
+#include "parser.h"
 #include "yasl_conf.h"
 
-void parser_register_node(struct Parser *parser, struct Node *node);
-void parser_unregister_node(struct Parser *parser, struct Node *node);
-
-struct Node *node_clone(const struct Node *const node) {
-	if (node == NULL) return NULL;
-	struct Node *clone = (struct Node *)malloc(sizeof(struct Node) + node->children_len * sizeof(struct Node *));
-	clone->nodetype = node->nodetype;
-	clone->children_len = node->children_len;
-	for (size_t i = 0; i < clone->children_len; i++) {
-		clone->children[i] = node_clone(node->children[i]);
-	}
-
-	switch (node->nodetype) {
-	case N_BINOP:
-		clone->value.binop = node->value.binop;
-		clone->value.binop.left = node_clone(node->value.binop.left);
-		clone->value.binop.right = node_clone(node->value.binop.right);
-		break;
-	case N_UNOP:
-		clone->value.unop = node->value.unop;
-		clone->value.unop.expr = node_clone(node->value.unop.expr);
-		break;
-	case N_TRIOP:
-		clone->value.type = node->value.type;
-		break;
-	case N_INT:
-	case N_BOOL:
-	case N_FLOAT:
-	case N_CALL:
-		clone->value.ival = node->value.ival;
-		break;
-	default:
-		clone->value.sval.len = node->value.sval.len;
-		clone->value.sval.str = (char *) malloc(node->value.sval.len + 1);
-		clone->value.sval.str[clone->value.sval.len] = '\0';
-		memcpy(clone->value.sval.str, node->value.sval.str, clone->value.sval.len);
-	}
-
-	clone->line = node->line;
-	return clone;
+static struct Node *node_alloc(struct Parser *parser, const size_t n) {
+	struct Node *const node = (struct Node *)yasl_arena_alloc(&parser->arena, sizeof(struct Node) + sizeof(struct Node *) * n);
+	node->children_cap = n;
+	return node;
 }
 
 static struct Node *new_Node(struct Parser *parser, const enum NodeType nodetype, const size_t line, const size_t name_len,
-		char *const name /* OWN */, const size_t n, ... /* OWN */) {
-	struct Node *const node = (struct Node *)malloc(sizeof(struct Node) + sizeof(struct Node *) * n);
-	node->next = NULL;
+		char *const name, const size_t n, ...) {
+	struct Node *const node = node_alloc(parser, n);
 	node->nodetype = nodetype;
 	node->children_len = n;
 
@@ -65,7 +29,6 @@ static struct Node *new_Node(struct Parser *parser, const enum NodeType nodetype
 	}
 	va_end(children);
 
-	parser_register_node(parser, node);
 	return node;
 }
 
@@ -167,10 +130,17 @@ DEF_GETTER(name, E, b, 1)
 
 void body_append(struct Parser *parser, struct Node **node, struct Node *const child) {
 	YASL_COMPILE_DEBUG_LOG("%s\n", "appending to block");
-	parser_unregister_node(parser, *node);
-	*node = (struct Node*)realloc(*node, sizeof(struct Node) + (++(*node)->children_len) * sizeof(struct Node *));
-	parser_register_node(parser, *node);
-	(*node)->children[(*node)->children_len - 1] = child;
+	if ((*node)->children_len == (*node)->children_cap) {
+		const size_t len = (*node)->children_len;
+		struct Node *const grown = node_alloc(parser, len ? len * 2 : 4);
+		memcpy(grown->children, (*node)->children, len * sizeof(struct Node *));
+		grown->nodetype = (*node)->nodetype;
+		grown->value = (*node)->value;
+		grown->line = (*node)->line;
+		grown->children_len = len;
+		*node = grown;
+	}
+	(*node)->children[(*node)->children_len++] = child;
 }
 
 struct Node *body_last(struct Node *body) {
@@ -218,8 +188,7 @@ DEF_NODE_ZSTR(Let, N_LET, expr)
 DEF_NODE_ZSTR(Const, N_CONST, expr)
 
 struct Node *new_TriOp(struct Parser *parser, enum Token op, struct Node *left, struct Node *middle, struct Node *right, const size_t line) {
-	struct Node *const node = (struct Node *)malloc(sizeof(struct Node) + sizeof(struct Node *) * 3);
-	node->next = NULL;
+	struct Node *const node = node_alloc(parser, 3);
 	node->nodetype = N_TRIOP;
 	node->children_len = 3;
 	node->value.type = op;
@@ -228,31 +197,26 @@ struct Node *new_TriOp(struct Parser *parser, enum Token op, struct Node *left,
 	node->children[1] = middle;
 	node->children[2] = right;
 
-	parser_register_node(parser, node);
 	return node;
 }
 
 struct Node *new_BinOp(struct Parser *parser, enum Token op, struct Node *left, struct Node *right, const size_t line) {
-	struct Node *const node = (struct Node *)malloc(sizeof(struct Node) + sizeof(struct Node *) * 2);
-	node->next = NULL;
+	struct Node *const node = node_alloc(parser, 2);
 	node->nodetype = N_BINOP;
 	node->children_len = 0;
 	node->value.binop = ((struct BinOpNode) { op, left, right });
 	node->line = line;
 
-	parser_register_node(parser, node);
 	return node;
 }
 
 struct Node *new_UnOp(struct Parser *parser, enum Token op, struct Node *child, const size_t line) {
-	struct Node *const node = (struct Node *)malloc(sizeof(struct Node) + sizeof(struct Node *) * 1);
-	node->next = NULL;
+	struct Node *const node = node_alloc(parser, 1);
 	node->nodetype = N_UNOP;
 	node->children_len = 0;
 	node->value.unop = ((struct UnOpNode) { op, child });
 	node->line = line;
 
-	parser_register_node(parser, node);
 	return node;
 }
 
@@ -300,37 +264,6 @@ struct Node *new_VariadicContext(struct Node *const expr, const int expected) {
 	}
 }
 
-void node_del(struct Node *node) {
-	if (!node) return;
-	node_del(node->next);
-	switch (node->nodetype) {
-	case N_PATALT:
-	case N_BINOP:
-	case N_UNOP:
-	case N_TRIOP:
-	case N_BOOL:
-	case N_INT:
-	case N_FLOAT:
-	case N_PATBOOL:
-	case N_PATINT:
-	case N_PATFL:
-	case N_CALL:
-		break;
-	case N_VAR:
-	case N_LET:
-	case N_STR:
-	case N_CONST:
-	case N_LETITER:
-	case N_PATCONST:
-	case N_PATLET:
-	case N_PATSTR:
-		free(node->value.sval.str);
-	default:
-		break;
-	}
-	free(node);
-}
-
 struct Node *Block_get_block(const struct Node *const node) {
 	YASL_ASSERT(node->nodetype == N_BLOCK, "Expected Block");
 	return node->children[0];
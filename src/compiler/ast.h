@@ -52,7 +52,6 @@ struct BodyNode {
 };
 
 struct Node {
-	struct Node *next;
 	enum NodeType nodetype;
 	union {
 		struct LString sval;
@@ -64,6 +63,7 @@ struct Node {
 	} value;
 	size_t line;
 	size_t children_len;
+	size_t children_cap;
 	struct Node *children[];
 };
 
@@ -72,8 +72,6 @@ struct Parser;
 void body_append(struct Parser *parser, struct Node **node, struct Node *const child);
 struct Node *body_last(struct Node *node);
 
-struct Node *node_clone(const struct Node *const node);
-
 bool will_var_expand(struct Node *node);
 
 #define FOR_CHILDREN(i, child, node) struct Node *child;\
@@ -198,6 +196,5 @@ yasl_float Float_get_float(const struct Node *const node);
 bool Boolean_get_bool(const struct Node *const node);
 char *Var_get_name(const struct Node *const node);
 
-void node_del(struct Node *node);
 
 #endif
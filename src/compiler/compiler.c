@@ -15,6 +15,7 @@
 
 static void validate_stmt(struct Compiler *compiler, const struct Node *const node);
 static void validate_expr(struct Compiler *compiler, const struct Node *const node);
+static void validate_Body(struct Compiler *compiler, const struct Node *const node);
 
 YASL_FORMAT_CHECK static void compiler_print_err(struct Compiler *compiler, const char *const fmt, ...) {
 	va_list args;
@@ -53,6 +54,7 @@ void compiler_cleanup(struct Compiler *const compiler) {
 	scope_del(compiler->globals);
 	scope_del(compiler->stack);
 	env_del(compiler->params);
+	symboltable_cleanup(&compiler->symbols);
 	parser_cleanup(&compiler->parser);
 	compiler_buffers_del(compiler);
 	free(compiler->checkpoints.items);
@@ -141,42 +143,55 @@ static size_t get_stacksize(const struct Compiler *const compiler) {
 	return scope_len(get_scope_in_use(compiler));
 }
 
-static struct Env *get_nearest(struct Env *env, const char *const name) {
-	while (!env_contains_cur_only(env, name)) {
+static int64_t compiler_symbol(struct Compiler *const compiler, const char *const name) {
+	return symboltable_intern(&compiler->symbols, name, strlen(name));
+}
+
+static struct Env *get_nearest(struct Env *env, const int64_t symbol) {
+	while (!env_contains_cur_only(env, symbol)) {
 		env = env->parent;
 	}
 	return env;
 }
 
-static void load_var_local(struct Compiler *const compiler, const struct Scope *scope, const char *const name) {
-	int64_t index = get_index(scope_get(scope, name));
+static void load_var_local(struct Compiler *const compiler, const struct Scope *scope, const int64_t symbol) {
+	int64_t index = get_index(scope_get(scope, symbol));
 	compiler_add_code_BB(compiler, O_LLOAD, (unsigned char) index);
 }
 
-static void load_var_from_upval(struct Compiler *const compiler, const char *const name) {
+static void load_var_from_upval(struct Compiler *const compiler, const int64_t symbol) {
 	compiler->params->isclosure = true;
-	yasl_int tmp = env_resolve_upval_index(compiler->params, compiler->stack, name);
+	yasl_int tmp = env_resolve_upval_index(compiler->params, compiler->stack, symbol);
 	compiler_add_code_BB(compiler, O_ULOAD, (unsigned char) tmp);
 }
 
 
 static bool var_is_defined(struct Compiler *const compiler, const char *const name) {
-	return env_contains(compiler->params, name) || scope_contains(compiler->stack, name) || scope_contains(compiler->globals, name);
+	const int64_t symbol = compiler_symbol(compiler, name);
+	// A body compiled on its first call only sees the variables it captures, so it must capture the ones it checks too.
+	if (compiler->validating_lazy && in_function(compiler) && !env_contains_cur_only(compiler->params, symbol) &&
+	    (env_contains(compiler->params, symbol) || scope_contains(compiler->stack, symbol))) {
+		if (env_contains(compiler->params, symbol)) get_nearest(compiler->params, symbol)->usedinclosure = true;
+		compiler->params->isclosure = true;
+		env_resolve_upval_index(compiler->params, compiler->stack, symbol);
+	}
+	return env_contains(compiler->params, symbol) || scope_contains(compiler->stack, symbol) || scope_contains(compiler->globals, symbol);
 }
 
 // NOTE: Keep this in sync with `var_is_defined`, and add tests for `ifdef` if you change this.
 static void load_var(struct Compiler *const compiler, const char *const name, const size_t line) {
-	if (in_function(compiler) && env_contains_cur_only(compiler->params, name)) {   // fn-local var
-		load_var_local(compiler, compiler->params->scope, name);
-	} else if (env_contains(compiler->params, name)) {                         // closure over fn-local variable
-		struct Env *curr = get_nearest(compiler->params, name);
+	const int64_t symbol = compiler_symbol(compiler, name);
+	if (in_function(compiler) && env_contains_cur_only(compiler->params, symbol)) {   // fn-local var
+		load_var_local(compiler, compiler->params->scope, symbol);
+	} else if (env_contains(compiler->params, symbol)) {                         // closure over fn-local variable
+		struct Env *curr = get_nearest(compiler->params, symbol);
 		curr->usedinclosure = true;
-		load_var_from_upval(compiler, name);
-	} else if (in_function(compiler) && scope_contains(compiler->stack, name)) {    // closure over file-local var
-		load_var_from_upval(compiler, name);
-	} else if (scope_contains(compiler->stack, name)) {                        // file-local vars
-		load_var_local(compiler, compiler->stack, name);
-	} else if (scope_contains(compiler->globals, name)) {                      // global vars
+		load_var_from_upval(compiler, symbol);
+	} else if (in_function(compiler) && scope_contains(compiler->stack, symbol)) {    // closure over file-local var
+		load_var_from_upval(compiler, symbol);
+	} else if (scope_contains(compiler->stack, symbol)) {                        // file-local vars
+		load_var_local(compiler, compiler->stack, symbol);
+	} else if (scope_contains(compiler->globals, symbol)) {                      // global vars
 		compiler_add_code_BW(compiler, O_GLOAD_8, YASL_Table_search_zstring_int(compiler->strings, name).value.ival);
 	} else {
 		compiler_print_err_undeclared_var(compiler, name, line);
@@ -184,8 +199,9 @@ static void load_var(struct Compiler *const compiler, const char *const name, co
 	}
 }
 
-static void store_var_cur_scope(struct Compiler *const compiler, const struct Scope *const scope, const char *const name, const size_t line) {
-	int64_t index = scope_get(scope, name);
+static void store_var_cur_scope(struct Compiler *const compiler, const struct Scope *const scope, const int64_t symbol,
+				const char *const name, const size_t line) {
+	int64_t index = scope_get(scope, symbol);
 	if (is_const(index)) {
 		compiler_print_err_const(compiler, name, line);
 		handle_error(compiler);
@@ -194,31 +210,32 @@ static void store_var_cur_scope(struct Compiler *const compiler, const struct Sc
 	compiler_add_code_BB(compiler, O_LSTORE, (unsigned char)index);
 }
 
-static void store_var_in_upval(struct Compiler *const compiler, const char *const name) {
+static void store_var_in_upval(struct Compiler *const compiler, const int64_t symbol) {
 	compiler->params->isclosure = true;
-	yasl_int index = env_resolve_upval_index(compiler->params, compiler->stack, name);
+	yasl_int index = env_resolve_upval_index(compiler->params, compiler->stack, symbol);
 	compiler_add_code_BB(compiler, O_USTORE, (unsigned char)index);
 }
 
 static void store_var(struct Compiler *const compiler, const char *const name, const size_t line) {
-	if (in_function(compiler) && env_contains_cur_only(compiler->params, name)) { // fn-local variable
-		store_var_cur_scope(compiler, compiler->params->scope, name, line);
-	} else if (env_contains(compiler->params, name)) {                            // closure over fn-local variable
-		struct Env *curr = get_nearest(compiler->params, name);
+	const int64_t symbol = compiler_symbol(compiler, name);
+	if (in_function(compiler) && env_contains_cur_only(compiler->params, symbol)) { // fn-local variable
+		store_var_cur_scope(compiler, compiler->params->scope, symbol, name, line);
+	} else if (env_contains(compiler->params, symbol)) {                            // closure over fn-local variable
+		struct Env *curr = get_nearest(compiler->params, symbol);
 		curr->usedinclosure = true;
-		int64_t index = scope_get(curr->scope, name);
+		int64_t index = scope_get(curr->scope, symbol);
 		if (is_const(index))
 			goto handle_const_err;
-		store_var_in_upval(compiler, name);
-	} else if (in_function(compiler) && scope_contains(compiler->stack, name)) {  // closure over file-local var
-		int64_t index = scope_get(compiler->stack, name);
+		store_var_in_upval(compiler, symbol);
+	} else if (in_function(compiler) && scope_contains(compiler->stack, symbol)) {  // closure over file-local var
+		int64_t index = scope_get(compiler->stack, symbol);
 		if (is_const(index))
 			goto handle_const_err;
-		store_var_in_upval(compiler, name);
-	} else if (scope_contains(compiler->stack, name)) {                           // file-local vars
-		store_var_cur_scope(compiler, compiler->stack, name, line);
-	} else if (scope_contains(compiler->globals, name)) {                         // global vars
-		int64_t index = scope_get(compiler->globals, name);
+		store_var_in_upval(compiler, symbol);
+	} else if (scope_contains(compiler->stack, symbol)) {                           // file-local vars
+		store_var_cur_scope(compiler, compiler->stack, symbol, name, line);
+	} else if (scope_contains(compiler->globals, symbol)) {                         // global vars
+		int64_t index = scope_get(compiler->globals, symbol);
 		if (is_const(index))
 			goto handle_const_err;
 		compiler_add_code_BW(compiler, O_GSTORE_8, YASL_Table_search_zstring_int(compiler->strings, name).value.ival);
@@ -233,39 +250,43 @@ static void store_var(struct Compiler *const compiler, const char *const name, c
 	handle_error(compiler);
 }
 
-static int contains_var_in_current_scope(const struct Compiler *const compiler, const char *const name) {
+static int contains_var_in_current_scope(struct Compiler *const compiler, const char *const name) {
+	const int64_t symbol = compiler_symbol(compiler, name);
 	return in_function(compiler) ?
-	       scope_contains_cur_only(compiler->params->scope, name) :
+	       scope_contains_cur_only(compiler->params->scope, symbol) :
 	       compiler->stack ?
-	       scope_contains_cur_only(compiler->stack, name) :
-	       scope_contains_cur_only(compiler->globals, name);
+	       scope_contains_cur_only(compiler->stack, symbol) :
+	       scope_contains_cur_only(compiler->globals, symbol);
 }
 
-static int contains_var(const struct Compiler *const compiler, const char *const name) {
-	if (scope_contains(compiler->stack, name)) return true;
-	if (env_contains(compiler->params, name)) return true;
-	return scope_contains_cur_only(compiler->globals, name);
+static int contains_var(struct Compiler *const compiler, const char *const name) {
+	const int64_t symbol = compiler_symbol(compiler, name);
+	if (scope_contains(compiler->stack, symbol)) return true;
+	if (env_contains(compiler->params, symbol)) return true;
+	return scope_contains_cur_only(compiler->globals, symbol);
 }
 
 static void decl_var(struct Compiler *const compiler, const char *const name, const size_t line) {
 	const size_t name_len = strlen(name);
+	const int64_t symbol = symboltable_intern(&compiler->symbols, name, name_len);
 	struct Scope *scope = get_scope_in_use(compiler);
 	if (scope) {
-		int64_t index = scope_decl_var(scope, name);
+		int64_t index = scope_decl_var(scope, symbol);
 		if (index > 255) {
 			compiler_print_err_syntax(compiler, "Too many variables in current scope (line %" PRI_SIZET ").\n",  line);
 			handle_error(compiler);
 		}
 	} else {
 		compiler_intern_string(compiler, name, name_len);
-		scope_decl_var(compiler->globals, name);
+		scope_decl_var(compiler->globals, symbol);
 	}
 }
 
-static void make_const(const struct Compiler * const compiler, const char *const name) {
+static void make_const(struct Compiler *const compiler, const char *const name) {
+	const int64_t symbol = compiler_symbol(compiler, name);
 	struct Scope *scope = get_scope_in_use(compiler);
-	if (scope) scope_make_const(scope, name);
-	else scope_make_const(compiler->globals, name);
+	if (scope) scope_make_const(scope, symbol);
+	else scope_make_const(compiler->globals, symbol);
 }
 
 static unsigned char *return_bytes(const struct Compiler *const compiler) {
@@ -310,11 +331,17 @@ static unsigned char *return_bytes(const struct Compiler *const compiler) {
 	return bytecode;
 }
 
+size_t compiler_bytecode_size(const struct Compiler *const compiler) {
+	return compiler->header->count + compiler->code->count + 1 + compiler->lines->count;
+}
+
 #define X(name, ...) static int visit_##name(struct Compiler *const compiler, const struct Node *const node, int target, int num_temps);
 #include "exprnodetype.x"
 #undef X
 
 static int visit_expr(struct Compiler *const compiler, const struct Node *const node, int target, int num_temps);
+static void enter_fn(struct Compiler *const compiler, const struct Node *const params);
+static void exit_fn(struct Compiler *const compiler, const struct Node *const node, const bool lazy);
 static void visit_patt(struct Compiler *const compiler, const struct Node *const node);
 static void visit_stmt(struct Compiler *const compiler, const struct Node *const node);
 
@@ -339,6 +366,41 @@ unsigned char *compile(struct Compiler *const compiler) {
 		compiler->buffer->count = 0;
 	}
 	exit_scope(compiler);
+	yasl_arena_free(&compiler->parser.arena);
+
+	return return_bytes(compiler);
+}
+
+unsigned char *compile_fn(struct Compiler *const compiler) {
+	struct Parser *const parser = &compiler->parser;
+	gettok(&parser->lex);
+	const size_t line = parserline(parser);
+	struct Node *body = new_Body(parser, line);
+	while (!peof(parser)) {
+		struct Node *node = parse(parser);
+		if (parser->status) {
+			compiler->status |= parser->status;
+			return NULL;
+		}
+		eattok(parser, T_SEMI);
+		if (parser->status) {
+			compiler->status |= parser->status;
+			return NULL;
+		}
+		if (node->nodetype == N_EXPORT) {
+			struct Node *exprs = new_Exprs(parser, node->line);
+			body_append(parser, &exprs, Export_get_expr(node));
+			node = new_Return(parser, exprs, node->line);
+		}
+		body_append(parser, &body, node);
+	}
+
+	enter_scope(compiler);
+	visit_stmt(compiler, new_Export(parser, new_FnDecl(parser, new_Body(parser, line), body, NULL, line), line));
+	YASL_ByteBuffer_extend(compiler->code, compiler->buffer->items, compiler->buffer->count);
+	compiler->buffer->count = 0;
+	exit_scope(compiler);
+	yasl_arena_free(&parser->arena);
 
 	return return_bytes(compiler);
 }
@@ -361,10 +423,98 @@ unsigned char *compile_REPL(struct Compiler *const compiler) {
 			compiler->buffer->count = 0;
 		}
 	}
+	yasl_arena_free(&compiler->parser.arena);
 
 	return return_bytes(compiler);
 }
 
+static int64_t stub_read_int(const unsigned char **stub) {
+	int64_t n;
+	memcpy(&n, *stub, sizeof(int64_t));
+	*stub += sizeof(int64_t);
+	return n;
+}
+
+/*
+ * Returns the program for code compiled on its own, without a copy of the constants, since those are shared with the
+ * rest of the program.
+ */
+static unsigned char *return_lazy_bytes(const struct Compiler *const compiler) {
+	const int64_t header[3] = { 3 * sizeof(int64_t), (int64_t)(3 * sizeof(int64_t) + compiler->code->count + 1), 0 };
+	unsigned char *bytecode = (unsigned char *)malloc(sizeof(header) + compiler->code->count + 1 + compiler->lines->count);
+	memcpy(bytecode, header, sizeof(header));
+	memcpy(bytecode + sizeof(header), compiler->code->items, compiler->code->count);
+	bytecode[sizeof(header) + compiler->code->count] = O_HALT;
+	memcpy(bytecode + sizeof(header) + compiler->code->count + 1, compiler->lines->items, compiler->lines->count);
+	return bytecode;
+}
+
+unsigned char *compile_lazy(struct Compiler *const compiler, const unsigned char *const stub, struct IO *const err) {
+	const unsigned char *tmp = stub;
+	const size_t line = (size_t)stub_read_int(&tmp);
+	const size_t num_upvals = *tmp++;
+	const unsigned char *const upvals = tmp;
+	for (size_t i = 0; i < num_upvals; i++) {
+		tmp++;
+		tmp += stub_read_int(&tmp);
+	}
+	const size_t len = (size_t)stub_read_int(&tmp);
+
+	// Compile against the same constants, globals and names as the rest of the program.
+	struct Compiler lazy = NEW_COMPILER(lexinput_new_bb((const char *)tmp, len));
+	YASL_Table_del(lazy.strings);
+	lazy.strings = compiler->strings;
+	YASL_ByteBuffer_del(lazy.header);
+	lazy.header = compiler->header;
+	scope_del(lazy.globals);
+	lazy.globals = compiler->globals;
+	lazy.symbols = compiler->symbols;
+	lazy.parser.lex.err = *err;
+	lazy.parser.lex.line = line;
+	lazy.parser.allow_echo = compiler->parser.allow_echo;
+	lazy.lazy_fns = true;
+
+	// The upvalues stand in for the file, so that resolving them again gives each the same index.
+	lazy.stack = scope_new(NULL);
+	int64_t *symbols = (int64_t *)malloc(sizeof(int64_t) * (num_upvals + 1));
+	tmp = upvals;
+	for (size_t i = 0; i < num_upvals; i++) {
+		const bool isconst = *tmp++;
+		const size_t name_len = (size_t)stub_read_int(&tmp);
+		symbols[i] = symboltable_intern(&lazy.symbols, (const char *)tmp, name_len);
+		tmp += name_len;
+		scope_decl_var(lazy.stack, symbols[i]);
+		if (isconst) scope_make_const(lazy.stack, symbols[i]);
+	}
+
+	struct Node *node = parse_fn_source(&lazy.parser);
+	lazy.status |= lazy.parser.status;
+	if (!lazy.status) {
+		enter_fn(&lazy, FnDecl_get_params(node));
+		for (size_t i = 0; i < num_upvals; i++) {
+			lazy.params->isclosure = true;
+			env_resolve_upval_index(lazy.params, lazy.stack, symbols[i]);
+		}
+		exit_fn(&lazy, node, false);
+		YASL_ByteBuffer_extend(lazy.code, lazy.buffer->items, lazy.buffer->count);
+		YASL_ByteBuffer_add_vint(lazy.lines, lazy.code->count);
+	}
+	free(symbols);
+
+	unsigned char *bytecode = lazy.status ? NULL : return_lazy_bytes(&lazy);
+
+	compiler->symbols = lazy.symbols;
+	lazy.symbols = NEW_SYMBOLTABLE();
+	lazy.strings = NULL;
+	lazy.header = YASL_ByteBuffer_new(0);
+	lazy.globals = NULL;
+	*err = lazy.parser.lex.err;
+	lazy.parser.lex.err = NEW_IO(NULL);
+	compiler_cleanup(&lazy);
+
+	return bytecode;
+}
+
 static void visit_Body(struct Compiler *const compiler, const struct Node *const node) {
 	FOR_CHILDREN(i, child, node) {
 		visit_stmt(compiler, child);
@@ -401,13 +551,12 @@ static unsigned char return_op(struct Compiler *compiler) {
 	return compiler->params->usedinclosure ? O_CRET : O_RET;
 }
 
-static int visit_FnDecl(struct Compiler *const compiler, const struct Node *const node, int target, int num_temps) {
-	YASL_UNUSED(target);
+static void enter_fn(struct Compiler *const compiler, const struct Node *const params) {
 	compiler->params = env_new(compiler->params);
 
 	enter_scope(compiler);
 
-	FOR_CHILDREN(i, child, FnDecl_get_params(node)) {
+	FOR_CHILDREN(i, child, params) {
 		if (child->nodetype == N_VARGS) {
 			decl_var(compiler, "...", child->line);
 		} else {
@@ -417,7 +566,52 @@ static int visit_FnDecl(struct Compiler *const compiler, const struct Node *cons
 			}
 		}
 	}
+}
+
+static bool fn_is_lazy(const struct Compiler *const compiler, const struct Node *const body) {
+#ifdef YASL_LAZY_FN_MIN_LEN
+	return compiler->lazy_fns && body->value.sval.str != NULL && body->value.sval.len >= YASL_LAZY_FN_MIN_LEN;
+#else
+	YASL_UNUSED(compiler);
+	YASL_UNUSED(body);
+	return false;
+#endif
+}
+
+/*
+ * Stands in for the body of a function until its first call. It holds everything compile_lazy needs: the line the
+ * function starts on, the name of each upvalue and whether it is const, in order, and the source of the function.
+ */
+static void add_lazy_stub(struct Compiler *const compiler, const struct Node *const body) {
+	compiler_add_code_BW(compiler, O_LAZY, (yasl_int)body->line);
+
+	const struct SymbolMap *const upvals = &compiler->params->upval_indices;
+	int64_t *symbols = (int64_t *)malloc(sizeof(int64_t) * (upvals->count + 1));
+	FOR_SYMBOLMAP(i, item, upvals) {
+		symbols[item->value] = item->symbol;
+	}
 
+	compiler_add_byte(compiler, (unsigned char)upvals->count);
+	for (size_t i = 0; i < upvals->count; i++) {
+		const int64_t symbol = symbols[i];
+		const struct LString *name = &compiler->symbols.names[symbol];
+		const struct Scope *scope = env_contains(compiler->params, symbol) ?
+			get_nearest(compiler->params, symbol)->scope : compiler->stack;
+		compiler_add_byte(compiler, (unsigned char)is_const(scope_get(scope, symbol)));
+		compiler_add_int(compiler, (yasl_int)name->len);
+		YASL_ByteBuffer_extend(compiler->buffer, (const unsigned char *)name->str, name->len);
+	}
+	free(symbols);
+
+	compiler_add_int(compiler, (yasl_int)body->value.sval.len);
+	YASL_ByteBuffer_extend(compiler->buffer, (const unsigned char *)body->value.sval.str, body->value.sval.len);
+}
+
+/*
+ * Adds the function literal for node, whose parameters have been declared by enter_fn, and leaves the function. If
+ * lazy, the body is replaced by a stub that compiles it on the first call.
+ */
+static void exit_fn(struct Compiler *const compiler, const struct Node *const node, const bool lazy) {
 	compiler_add_code_BW(compiler, O_FCONST, -1);
 
 	size_t old_size = compiler->buffer->count;
@@ -428,10 +622,19 @@ static int visit_FnDecl(struct Compiler *const compiler, const struct Node *cons
 	size_t num_params = Body_get_len(FnDecl_get_params(node)) - (int)is_variadic;
 	// TODO: verfiy that number of params is small enough. (same for the other casts below.)
 	compiler_add_byte(compiler, (unsigned char)(is_variadic ? ~num_params : num_params));
-	visit_Body(compiler, FnDecl_get_body(node));
+	if (lazy) {
+		// Resolve every name now, so that errors are reported up front and only the variables the body uses are captured.
+		const bool validating_lazy = compiler->validating_lazy;
+		compiler->validating_lazy = true;
+		validate_Body(compiler, body);
+		compiler->validating_lazy = validating_lazy;
+		add_lazy_stub(compiler, body);
+	} else {
+		visit_Body(compiler, body);
 
-	// Implicit return at the end of the function.
-	compiler_add_code_BB(compiler, return_op(compiler), (unsigned char)get_stacksize(compiler));
+		// Implicit return at the end of the function.
+		compiler_add_code_BB(compiler, return_op(compiler), (unsigned char)get_stacksize(compiler));
+	}
 
 	exit_scope(compiler);
 
@@ -447,9 +650,9 @@ static int visit_FnDecl(struct Compiler *const compiler, const struct Node *cons
 		for (size_t i = 0; i < count; i++) {
 			compiler_add_byte(compiler, 0);
 		}
-		FOR_TABLE(i, item, &compiler->params->upval_indices) {
-			int64_t index = item->value.value.ival;
-			int64_t value = YASL_Table_search(&compiler->params->upval_values, item->key).value.ival;
+		FOR_SYMBOLMAP(i, item, &compiler->params->upval_indices) {
+			int64_t index = item->value;
+			int64_t value = env_resolve_upval_value(compiler->params, item->symbol);
 			compiler->buffer->items[start + index] = value;
 		}
 	}
@@ -458,6 +661,12 @@ static int visit_FnDecl(struct Compiler *const compiler, const struct Node *cons
 	compiler->params->parent = NULL;
 	env_del(compiler->params);
 	compiler->params = tmp;
+}
+
+static int visit_FnDecl(struct Compiler *const compiler, const struct Node *const node, int target, int num_temps) {
+	YASL_UNUSED(target);
+	enter_fn(compiler, FnDecl_get_params(node));
+	exit_fn(compiler, node, fn_is_lazy(compiler, FnDecl_get_body(node)));
 
 	return num_temps + 1;
 }
@@ -831,6 +1040,75 @@ yasl_int compiler_intern_int(struct Compiler *const compiler, const yasl_int val
 	return value.value.ival;
 }
 
+static bool intern_constants(struct Compiler *const compiler, const unsigned char *tmp, const int64_t num_constants) {
+	for (int64_t i = 0; i < num_constants; i++) {
+		yasl_int index;
+		switch (*tmp++) {
+		case C_STR: {
+			int64_t len;
+			memcpy(&len, tmp, sizeof(int64_t));
+			tmp += sizeof(int64_t);
+			index = compiler_intern_string(compiler, (const char *)tmp, (size_t)len);
+			tmp += len;
+			break;
+		}
+		case C_INT_1:
+			index = compiler_intern_int(compiler, (signed char)*tmp++);
+			break;
+		case C_INT_8: {
+			yasl_int val;
+			memcpy(&val, tmp, sizeof(yasl_int));
+			tmp += sizeof(yasl_int);
+			index = compiler_intern_int(compiler, val);
+			break;
+		}
+		case C_FLOAT: {
+			yasl_float val;
+			memcpy(&val, tmp, sizeof(yasl_float));
+			tmp += sizeof(yasl_float);
+			index = compiler_intern_float(compiler, val);
+			break;
+		}
+		default:
+			return false;
+		}
+		if (index != i) return false;
+	}
+	return compiler->strings->count == (size_t)num_constants;
+}
+
+/*
+ * Forgets every constant after the first num_constants, which take up header_len bytes of the header.
+ */
+static void truncate_constants(struct Compiler *const compiler, const size_t num_constants, const size_t header_len) {
+	const size_t num_extra = compiler->strings->count - num_constants;
+	struct YASL_Object *extra = (struct YASL_Object *)malloc(sizeof(struct YASL_Object) * (num_extra + 1));
+	size_t found = 0;
+	FOR_TABLE(i, item, compiler->strings) {
+		if (item->value.value.ival >= (yasl_int)num_constants) extra[found++] = item->key;
+	}
+	for (size_t i = 0; i < found; i++) {
+		YASL_Table_rm(compiler->strings, extra[i]);
+	}
+	free(extra);
+	compiler->header->count = header_len;
+}
+
+bool compiler_intern_constants(struct Compiler *const compiler, const unsigned char *const bytecode) {
+	const size_t num_constants = compiler->strings->count;
+	const size_t header_len = compiler->header->count;
+	if (intern_constants(compiler, bytecode + 3 * sizeof(int64_t), ((const int64_t *)bytecode)[2])) return true;
+	truncate_constants(compiler, num_constants, header_len);
+	return false;
+}
+
+void compiler_copy_globals(struct Compiler *const compiler, const struct Compiler *const src) {
+	intern_constants(compiler, src->header->items + 3 * sizeof(int64_t), (int64_t)src->strings->count);
+	symboltable_copy(&compiler->symbols, &src->symbols);
+	scope_del(compiler->globals);
+	compiler->globals = scope_copy_cur_only(src->globals);
+}
+
 static yasl_int intern_string(struct Compiler *const compiler, const struct Node *const node) {
 	const char *const str = String_get_str(node);
 	size_t len = String_get_len(node);
@@ -916,7 +1194,7 @@ static void visit_DeclPattern(struct Compiler *const compiler, const struct Node
 	}
 
 	compiler_add_byte(compiler, P_BIND);
-	int64_t index = scope_get(get_scope_in_use(compiler), name);
+	int64_t index = scope_get(get_scope_in_use(compiler), compiler_symbol(compiler, name));
 	if (is_const(index) != isconst) {
 		compiler_print_err_syntax(compiler, "%s must be bound with either `const` or `let` on both sides of | (line %" PRI_SIZET ").\n", name, node->line);
 		handle_error(compiler);
@@ -1200,7 +1478,7 @@ static void declare_with_let_or_const(struct Compiler *const compiler, const str
 
 	struct Scope *scope = get_scope_in_use(compiler);
 
-	if (!(scope_contains(scope, name))) {
+	if (!(scope_contains(scope, compiler_symbol(compiler, name)))) {
 		store_var(compiler, name, node->line);
 	}
 }
@@ -1293,10 +1571,57 @@ static void visit_BinOp_shortcircuit(struct Compiler *const compiler, const stru
 	YASL_ByteBuffer_rewrite_int_fast(compiler->buffer, index - 8, compiler->buffer->count - index);
 }
 
+static void compiler_add_literal(struct Compiler *const compiler, const yasl_int index) {
+	if (index < 128) {
+		compiler_add_code_BB(compiler, O_LIT, (unsigned char)index);
+	} else {
+		compiler_add_code_BW(compiler, O_LIT8, index);
+	}
+}
+
+#define MAX_CNCT_OPERANDS 255
+
+/*
+ * Visits every operand of a chain of `~`, left to right, so that the whole chain can be built with one O_CNCT_N.
+ * Since `~` is associative, parenthesised sub-chains are flattened too. Empty str literals are skipped, since they
+ * cannot change the result. Returns the number of operands pushed since the last O_CNCT_N.
+ */
+static int visit_concat_operands(struct Compiler *const compiler, const struct Node *const node, int num_temps,
+				 int count) {
+	const struct Node *const inner = node->nodetype == N_PARENS ? Parens_get_expr(node) : NULL;
+	if (inner && inner->nodetype == N_BINOP && inner->value.type == T_TILDE) {
+		return visit_concat_operands(compiler, Parens_get_expr(node), num_temps, count);
+	}
+
+	if (node->nodetype == N_BINOP && node->value.type == T_TILDE) {
+		count = visit_concat_operands(compiler, BinOp_get_left(node), num_temps, count);
+		return visit_concat_operands(compiler, BinOp_get_right(node), num_temps, count);
+	}
+
+	if (node->nodetype == N_STR && String_get_len(node) == 0) {
+		return count;
+	}
+
+	if (count == MAX_CNCT_OPERANDS) {
+		compiler_add_code_BB(compiler, O_CNCT_N, (unsigned char)count);
+		count = 1;
+	}
+	visit_expr(compiler, node, num_temps + count, num_temps + count);
+	return count + 1;
+}
+
 static int visit_BinOp(struct Compiler *const compiler, const struct Node *const node, int target, int num_temps) {
 	YASL_UNUSED(target);
 	// complicated bin ops are handled on their own.
-	if (node->value.type == T_DQMARK) {        // ?? operator
+	if (node->value.type == T_TILDE) {         // ~ operator, including interpolated strings
+		int count = visit_concat_operands(compiler, node, num_temps, 0);
+		if (count == 0) {
+			compiler_add_literal(compiler, compiler_intern_string(compiler, "", 0));
+			count = 1;
+		}
+		compiler_add_code_BB(compiler, O_CNCT_N, (unsigned char)count);
+		return num_temps + 1;
+	} else if (node->value.type == T_DQMARK) {        // ?? operator
 		visit_BinOp_shortcircuit(compiler, node, O_BRN_8, num_temps);
 		return num_temps + 1;
 	} else if (node->value.type == T_DBAR) {   // || operator
@@ -1357,9 +1682,6 @@ static int visit_BinOp(struct Compiler *const compiler, const struct Node *const
 	case T_LTEQ:
 		compiler_add_byte(compiler, O_LE);
 		break;
-	case T_TILDE:
-		compiler_add_byte(compiler, O_CNCT);
-		break;
 	case T_DGT:
 		compiler_add_byte(compiler, O_BSR);
 		break;
@@ -1451,14 +1773,6 @@ static int visit_Undef(struct Compiler *const compiler, const struct Node *const
 	return num_temps + 1;
 }
 
-static void compiler_add_literal(struct Compiler *const compiler, const yasl_int index) {
-	if (index < 128) {
-		compiler_add_code_BB(compiler, O_LIT, (unsigned char)index);
-	} else {
-		compiler_add_code_BW(compiler, O_LIT8, index);
-	}
-}
-
 static int visit_Float(struct Compiler *const compiler, const struct Node *const node, int target, int num_temps) {
 	YASL_UNUSED(target);
 	yasl_float val = Float_get_float(node);
@@ -1537,6 +1851,7 @@ static int visit_Table(struct Compiler *const compiler, const struct Node *const
 
 DEF_VALIDATE(expr, compiler, node, (int)get_stacksize(compiler), (int)get_stacksize(compiler))
 DEF_VALIDATE(stmt, compiler, node)
+DEF_VALIDATE(Body, compiler, node)
 
 static void visit_LetIter(struct Compiler *const compiler, const struct Node *const node) {
 	YASL_UNUSED(compiler);
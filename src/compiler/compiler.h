@@ -5,6 +5,7 @@
 
 #include "data-structures/YASL_Buffer.h"
 #include "data-structures/YASL_ByteBuffer.h"
+#include "data-structures/YASL_Table.h"
 #include "common/debug.h"
 #include "env.h"
 #include "parser.h"
@@ -21,6 +22,7 @@ DECL_BUFFER(size_t)
 #define NEW_COMPILER(fp)\
 ((struct Compiler) {\
 	.parser = NEW_PARSER(fp),\
+	.symbols = NEW_SYMBOLTABLE(),\
 	.globals = scope_new(NULL),\
 	.stack = NULL,\
 	.params = NULL,\
@@ -36,11 +38,14 @@ DECL_BUFFER(size_t)
 	.checkpoints = NEW_SIZEBUFFER(4),\
 	.status = YASL_SUCCESS,\
 	.num = 0,\
+	.lazy_fns = false,\
+	.validating_lazy = false,\
 })
 
 struct Compiler {
 	jmp_buf buf;
 	struct Parser parser;
+	struct SymbolTable symbols;  // names of all variables, so that scopes can be keyed by symbol
 	struct Scope *globals;
 	struct Scope *stack;
 	struct Env *params;
@@ -56,13 +61,41 @@ struct Compiler {
 	BUFFER(size_t) checkpoints;
 	int status;
 	int64_t num;
+	bool lazy_fns;              // whether to leave long function bodies to be compiled on their first call
+	bool validating_lazy;       // whether names are being checked in a body left to be compiled on its first call
 };
 
 struct Compiler *compiler_new(FILE *const fp);
 struct Compiler *compiler_new_bb(const char *const buf, const size_t len);
 yasl_int compiler_intern_string(struct Compiler *const compiler, const char *const str, const size_t len);
+/*
+ * Interns the constants of already compiled bytecode, in order, so that code compiled afterwards (such as a required
+ * module) agrees with it on constant indices. Returns false if they can't be given the same indices as in bytecode, or
+ * if the compiler already held constants that bytecode lacks, in which case the compiler's constants are left as they
+ * were.
+ */
+bool compiler_intern_constants(struct Compiler *const compiler, const unsigned char *const bytecode);
+/*
+ * Gives compiler, which must not have interned anything yet, the same constants, symbols and global variables as src,
+ * so that it compiles code the way src would.
+ */
+void compiler_copy_globals(struct Compiler *const compiler, const struct Compiler *const src);
 void compiler_cleanup(struct Compiler *const compiler);
 unsigned char *compile(struct Compiler *const compiler);
+/*
+ * Compiles the input as the body of a function taking no arguments, and returns a program that exports it. A top-level
+ * `export expr` in the input becomes `return expr`. The program starts with the O_FCONST for the function.
+ */
+unsigned char *compile_fn(struct Compiler *const compiler);
+/*
+ * Compiles the body of a function that compile left for its first call, given the operands of its O_LAZY. The
+ * returned program holds no constants of its own; any new ones are added to the compiler's, as if they had been found
+ * by compile. The program starts with the O_FCONST for the function. Returns NULL, having printed the error to err, if
+ * the body fails to compile.
+ */
+unsigned char *compile_lazy(struct Compiler *const compiler, const unsigned char *const stub, struct IO *const err);
+// Size in bytes of the bytecode returned by the last successful call to compile or compile_REPL.
+size_t compiler_bytecode_size(const struct Compiler *const compiler);
 unsigned char *compile_REPL(struct Compiler *const compiler);
 
 #endif
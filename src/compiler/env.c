@@ -1,39 +1,163 @@
 #include "env.h"
 
-#include <stdio.h>
 #include <string.h>
-#include <stdlib.h>
-#include <interpreter/YASL_Object.h>
 
 #include "common/debug.h"
-#include "data-structures/YASL_String.h"
+#include "yasl_conf.h"
+
+#define SYMBOLTABLE_BASESIZE 64
+#define SYMBOLMAP_BASESIZE 8
+
+static size_t symbol_name_hash(const char *name, const size_t len) {
+	// FNV-1a
+	size_t hash = (size_t)UINT64_C(14695981039346656037);
+	for (size_t i = 0; i < len; i++) {
+		hash ^= (unsigned char)name[i];
+		hash *= (size_t)UINT64_C(1099511628211);
+	}
+	return hash;
+}
+
+static int64_t *symboltable_slot(const struct SymbolTable *const table, const char *const name, const size_t len) {
+	const size_t mask = table->size - 1;
+	size_t index = symbol_name_hash(name, len) & mask;
+	int64_t *slot;
+	while (*(slot = &table->slots[index]) >= 0) {
+		const struct LString *curr = &table->names[*slot];
+		if (curr->len == len && !memcmp(curr->str, name, len)) {
+			break;
+		}
+		index = (index + 1) & mask;
+	}
+	return slot;
+}
+
+static void symboltable_resize(struct SymbolTable *const table, const size_t size) {
+	free(table->slots);
+	table->slots = (int64_t *)malloc(size * sizeof(int64_t));
+	table->size = size;
+	memset(table->slots, 0xFF, size * sizeof(int64_t));
+	table->names = (struct LString *)realloc(table->names, size * sizeof(struct LString));
+	for (size_t i = 0; i < table->count; i++) {
+		*symboltable_slot(table, table->names[i].str, table->names[i].len) = (int64_t)i;
+	}
+}
+
+int64_t symboltable_intern(struct SymbolTable *const table, const char *const name, const size_t len) {
+	if (table->count * 2 >= table->size) {
+		symboltable_resize(table, table->size ? table->size * 2 : SYMBOLTABLE_BASESIZE);
+	}
+	int64_t *slot = symboltable_slot(table, name, len);
+	if (*slot >= 0) return *slot;
+
+	char *copy = (char *)malloc(len + 1);
+	memcpy(copy, name, len);
+	copy[len] = '\0';
+	LString_init(&table->names[table->count], copy, len);
+	*slot = (int64_t)table->count;
+	return (int64_t)table->count++;
+}
+
+int64_t symboltable_find(const struct SymbolTable *const table, const char *const name, const size_t len) {
+	if (table->size == 0) return -1;
+	return *symboltable_slot(table, name, len);
+}
+
+void symboltable_cleanup(struct SymbolTable *const table) {
+	for (size_t i = 0; i < table->count; i++) {
+		free(table->names[i].str);
+	}
+	free(table->names);
+	free(table->slots);
+	*table = NEW_SYMBOLTABLE();
+}
+
+void symboltable_copy(struct SymbolTable *const dst, const struct SymbolTable *const src) {
+	symboltable_cleanup(dst);
+	if (src->size == 0) return;
+	dst->size = src->size;
+	dst->count = src->count;
+	dst->slots = (int64_t *)malloc(src->size * sizeof(int64_t));
+	memcpy(dst->slots, src->slots, src->size * sizeof(int64_t));
+	dst->names = (struct LString *)malloc(src->size * sizeof(struct LString));
+	for (size_t i = 0; i < src->count; i++) {
+		const size_t len = src->names[i].len;
+		char *copy = (char *)malloc(len + 1);
+		memcpy(copy, src->names[i].str, len + 1);
+		LString_init(&dst->names[i], copy, len);
+	}
+}
+
+static inline size_t symbolmap_index(const int64_t symbol, const size_t mask) {
+	return ((size_t)symbol * 0x9E3779B1u) & mask;
+}
+
+static struct SymbolMapItem *symbolmap_find(const struct SymbolMap *const map, const int64_t symbol) {
+	if (map->count == 0) return NULL;
+	const size_t mask = map->size - 1;
+	size_t index = symbolmap_index(symbol, mask);
+	struct SymbolMapItem *item;
+	while ((item = &map->items[index])->symbol >= 0) {
+		if (item->symbol == symbol) return item;
+		index = (index + 1) & mask;
+	}
+	return NULL;
+}
+
+static void symbolmap_insert(struct SymbolMap *const map, const int64_t symbol, const int64_t value);
+
+static void symbolmap_resize(struct SymbolMap *const map, const size_t size) {
+	struct SymbolMapItem *old_items = map->items;
+	const size_t old_size = map->size;
+	map->items = (struct SymbolMapItem *)malloc(size * sizeof(struct SymbolMapItem));
+	map->size = size;
+	map->count = 0;
+	for (size_t i = 0; i < size; i++) {
+		map->items[i].symbol = -1;
+	}
+	for (size_t i = 0; i < old_size; i++) {
+		if (old_items[i].symbol >= 0) symbolmap_insert(map, old_items[i].symbol, old_items[i].value);
+	}
+	free(old_items);
+}
+
+static void symbolmap_insert(struct SymbolMap *const map, const int64_t symbol, const int64_t value) {
+	if ((map->count + 1) * 4 > map->size * 3) {
+		symbolmap_resize(map, map->size ? map->size * 2 : SYMBOLMAP_BASESIZE);
+	}
+	const size_t mask = map->size - 1;
+	size_t index = symbolmap_index(symbol, mask);
+	struct SymbolMapItem *item;
+	while ((item = &map->items[index])->symbol >= 0 && item->symbol != symbol) {
+		index = (index + 1) & mask;
+	}
+	if (item->symbol < 0) {
+		item->symbol = symbol;
+		map->count++;
+	}
+	item->value = value;
+}
+
+static void symbolmap_cleanup(struct SymbolMap *const map) {
+	free(map->items);
+}
 
 struct Env *env_new(struct Env *const parent) {
 	struct Env *env = (struct Env *)malloc(sizeof(struct Env));
 	env->scope = NULL;
-	env->upval_indices = NEW_TABLE();
-	env->upval_values = NEW_TABLE();
+	env->upval_indices = NEW_SYMBOLMAP();
+	env->upval_values = NEW_SYMBOLMAP();
 	env->usedinclosure = false;
 	env->isclosure = false;
 	env->parent = parent;
 	return env;
 }
 
-static void YASL_Table_string_int_cleanup(struct YASL_Table *const table) {
-	for (size_t i = 0; i < table->size; i++) {
-		struct YASL_Table_Item *item = &table->items[i];
-		if (item->key.type != Y_END && item->key.type != Y_UNDEF) {
-			str_del(item->key.value.sval);
-		}
-	}
-	free(table->items);
-}
-
 void env_del(struct Env *const env) {
 	if (env == NULL) return;
 	scope_del(env->scope);
-	YASL_Table_string_int_cleanup(&env->upval_indices);
-	YASL_Table_string_int_cleanup(&env->upval_values);
+	symbolmap_cleanup(&env->upval_indices);
+	symbolmap_cleanup(&env->upval_values);
 	env_del(env->parent);
 	free(env);
 }
@@ -41,7 +165,7 @@ void env_del(struct Env *const env) {
 struct Scope *scope_new(struct Scope *const parent) {
 	struct Scope *scope = (struct Scope *)malloc(sizeof(struct Scope));
 	scope->parent = parent;
-	scope->vars = NEW_TABLE();
+	scope->vars = NEW_SYMBOLMAP();
 	return scope;
 }
 
@@ -52,8 +176,17 @@ void scope_del(struct Scope *const scope) {
 	scope_del_cur_only(scope);
 }
 
+struct Scope *scope_copy_cur_only(const struct Scope *const scope) {
+	struct Scope *copy = scope_new(NULL);
+	if (scope->vars.size == 0) return copy;
+	copy->vars = scope->vars;
+	copy->vars.items = (struct SymbolMapItem *)malloc(scope->vars.size * sizeof(struct SymbolMapItem));
+	memcpy(copy->vars.items, scope->vars.items, scope->vars.size * sizeof(struct SymbolMapItem));
+	return copy;
+}
+
 void scope_del_cur_only(struct Scope *const scope) {
-	YASL_Table_string_int_cleanup(&scope->vars);
+	symbolmap_cleanup(&scope->vars);
 	free(scope);
 }
 
@@ -67,32 +200,27 @@ size_t scope_len(const struct Scope *const scope) {
 	return scope_num_vars_cur_only(scope) + scope_len(scope->parent);
 }
 
-bool scope_contains_cur_only(const struct Scope *const scope, const char *const name) {
-	return YASL_Table_contains_zstring_int(&scope->vars, name);
+bool scope_contains_cur_only(const struct Scope *const scope, const int64_t symbol) {
+	return symbolmap_find(&scope->vars, symbol) != NULL;
 }
 
-bool scope_contains(const struct Scope *const scope, const char *const name) {
-	if (scope == NULL) return false;
-
-	const bool contains = scope_contains_cur_only(scope, name);
-	if (!contains && scope->parent == NULL) {
-		return false;
+bool scope_contains(const struct Scope *const scope, const int64_t symbol) {
+	for (const struct Scope *curr = scope; curr != NULL; curr = curr->parent) {
+		if (scope_contains_cur_only(curr, symbol)) return true;
 	}
-	if (!contains)
-		return scope_contains(scope->parent, name);
-	return true;
+	return false;
 }
 
-bool env_contains(const struct Env *env, const char *const name) {
+bool env_contains(const struct Env *env, const int64_t symbol) {
 	while (env != NULL) {
-		if (scope_contains(env->scope, name)) return true;
+		if (scope_contains(env->scope, symbol)) return true;
 		env = env->parent;
 	}
 	return false;
 }
 
-bool env_contains_cur_only(const struct Env *const env, const char *const name) {
-	return scope_contains(env->scope, name);
+bool env_contains_cur_only(const struct Env *const env, const int64_t symbol) {
+	return scope_contains(env->scope, symbol);
 }
 
 static int is_const(const int64_t value) {
@@ -104,81 +232,81 @@ static inline int64_t get_index(const int64_t value) {
 	return is_const(value) ? ~value : value;
 }
 
-static int64_t env_add_upval_kv(struct Env *env, const char *const name, yasl_int value) {
-	YASL_Table_insert_zstring_int(&env->upval_values, name, value);
+static int64_t env_add_upval_kv(struct Env *env, const int64_t symbol, yasl_int value) {
+	symbolmap_insert(&env->upval_values, symbol, value);
 	int64_t index = env->upval_indices.count;
-	YASL_Table_insert_zstring_int(&env->upval_indices, name, index);
+	symbolmap_insert(&env->upval_indices, symbol, index);
 	return index;
 }
 
-static int64_t env_add_upval(struct Env *env, struct Scope *stack, const char *const name) {
+static int64_t env_add_upval(struct Env *env, struct Scope *stack, const int64_t symbol) {
 	env->isclosure = true;
 
-	if (!env->parent && scope_contains(stack, name)) {
-		yasl_int value = get_index(scope_get(stack, name));
-		return env_add_upval_kv(env, name, value);
+	if (!env->parent && scope_contains(stack, symbol)) {
+		yasl_int value = get_index(scope_get(stack, symbol));
+		return env_add_upval_kv(env, symbol, value);
 	}
 
 	YASL_ASSERT(env->parent, "Parent cannot be null.");
 
-	if (!env_contains_cur_only(env->parent, name) && !YASL_Table_contains_zstring_int(&env->parent->upval_indices, name)) {
-		env_add_upval(env->parent, stack, name);
+	if (!env_contains_cur_only(env->parent, symbol) && !symbolmap_find(&env->parent->upval_indices, symbol)) {
+		env_add_upval(env->parent, stack, symbol);
 	}
 
-	if (env_contains_cur_only(env->parent, name)) {
+	if (env_contains_cur_only(env->parent, symbol)) {
 		env->parent->usedinclosure = true;
-		yasl_int value = get_index(scope_get(env->parent->scope, name));
-		return env_add_upval_kv(env, name, value);
+		yasl_int value = get_index(scope_get(env->parent->scope, symbol));
+		return env_add_upval_kv(env, symbol, value);
 	}
 
-	const struct YASL_Object res = YASL_Table_search_zstring_int(&env->parent->upval_indices, name);
-	if (obj_isint(&res)) {
-		yasl_int value = obj_getint(&res);
-		return env_add_upval_kv(env, name, value < 0 ? value : ~value);;
+	const struct SymbolMapItem *res = symbolmap_find(&env->parent->upval_indices, symbol);
+	if (res) {
+		yasl_int value = res->value;
+		return env_add_upval_kv(env, symbol, value < 0 ? value : ~value);
 	}
 
 	YASL_UNREACHED();
 	return 0;
 }
 
-int64_t env_resolve_upval_index(struct Env *const env, struct Scope *stack, const char *const name) {
-	const struct YASL_Object res = YASL_Table_search_zstring_int(&env->upval_indices, name);
+int64_t env_resolve_upval_index(struct Env *const env, struct Scope *stack, const int64_t symbol) {
+	const struct SymbolMapItem *res = symbolmap_find(&env->upval_indices, symbol);
 
-	if (obj_isint(&res)) {
-		return res.value.ival;
+	if (res) {
+		return res->value;
 	}
 
-	return env_add_upval(env, stack, name);
+	return env_add_upval(env, stack, symbol);
 }
 
 // Assumes that the upval in question is already in the upvals for env.
-int64_t env_resolve_upval_value(struct Env *const env, const char *const name) {
-	struct YASL_Object value = YASL_Table_search_zstring_int(&env->upval_values, name);
+int64_t env_resolve_upval_value(struct Env *const env, const int64_t symbol) {
+	const struct SymbolMapItem *value = symbolmap_find(&env->upval_values, symbol);
 
-	YASL_ASSERT(value.type == Y_INT, "Value must be found in upvals for env.");
+	YASL_ASSERT(value != NULL, "Value must be found in upvals for env.");
 
-	return obj_getint(&value);
+	return value->value;
 }
 
-int64_t scope_get(const struct Scope *const scope, const char *const name) {
-	struct YASL_Object value = YASL_Table_search_zstring_int(&scope->vars, name);
-	if (value.type == Y_END && scope->parent == NULL) {
-		YASL_ASSERT(false, "Lookup should not fail.");
+int64_t scope_get(const struct Scope *const scope, const int64_t symbol) {
+	for (const struct Scope *curr = scope; curr != NULL; curr = curr->parent) {
+		const struct SymbolMapItem *item = symbolmap_find(&curr->vars, symbol);
+		if (item) return item->value;
 	}
-	if (value.type == Y_END) return scope_get(scope->parent, name);
-	return value.value.ival;
+	YASL_ASSERT(false, "Lookup should not fail.");
+	return 0;
 }
 
-int64_t scope_decl_var(struct Scope *const scope, const char *const name) {
-	YASL_Table_insert_zstring_int(&scope->vars, name, scope_len(scope));
+int64_t scope_decl_var(struct Scope *const scope, const int64_t symbol) {
+	symbolmap_insert(&scope->vars, symbol, scope_len(scope));
 	return scope_len(scope);
 }
 
-static struct YASL_Table *get_closest_scope_with_var(struct Scope *const scope, const char *const name) {
-	return YASL_Table_contains_zstring_int(&scope->vars, name) ? &scope->vars : get_closest_scope_with_var(scope->parent, name);
-}
-
-void scope_make_const(struct Scope *const scope, const char *const name) {
-	struct YASL_Table *ht = get_closest_scope_with_var(scope, name);
-	YASL_Table_insert_zstring_int(ht, name, ~YASL_Table_search_zstring_int(ht, name).value.ival);
+void scope_make_const(struct Scope *const scope, const int64_t symbol) {
+	struct Scope *curr = scope;
+	struct SymbolMapItem *item;
+	while (!(item = symbolmap_find(&curr->vars, symbol))) {
+		curr = curr->parent;
+	}
+	item->value = ~item->value;
 }
@@ -1,18 +1,61 @@
 #ifndef YASL_ENV_H_
 #define YASL_ENV_H_
 
-#include "data-structures/YASL_Table.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "data-structures/LString.h"
+
+/*
+ * Names of variables, interned so that scopes can be keyed by small integers. Each distinct name gets the next
+ * symbol, starting at 0, and keeps it for the lifetime of the table.
+ */
+struct SymbolTable {
+	size_t size;            // number of slots, always a power of 2
+	size_t count;           // number of symbols
+	int64_t *slots;         // symbol in each slot, or -1 if the slot is empty
+	struct LString *names;  // name of each symbol, indexed by symbol
+};
+
+#define NEW_SYMBOLTABLE() ((struct SymbolTable) { 0, 0, NULL, NULL })
+
+int64_t symboltable_intern(struct SymbolTable *const table, const char *const name, const size_t len);
+// Returns -1 if name has not been interned.
+int64_t symboltable_find(const struct SymbolTable *const table, const char *const name, const size_t len);
+void symboltable_cleanup(struct SymbolTable *const table);
+// Replaces the contents of dst with a copy of src, so that every name keeps its symbol.
+void symboltable_copy(struct SymbolTable *const dst, const struct SymbolTable *const src);
+
+struct SymbolMapItem {
+	int64_t symbol;  // -1 if the slot is empty
+	int64_t value;
+};
+
+/*
+ * Map from symbols to ints, used for the variables of a scope and the upvalues of a function.
+ */
+struct SymbolMap {
+	size_t size;   // number of slots, always a power of 2, or 0 before the first insert
+	size_t count;
+	struct SymbolMapItem *items;
+};
+
+#define NEW_SYMBOLMAP() ((struct SymbolMap) { 0, 0, NULL })
+
+#define FOR_SYMBOLMAP(i, item, map) struct SymbolMapItem *item;\
+for (size_t i = 0; i < (map)->size; i++) if (item = &(map)->items[i], item->symbol >= 0)
 
 struct Scope {
 	struct Scope *parent;
-	struct YASL_Table vars;
+	struct SymbolMap vars;
 };
 
 struct Env {
 	struct Env *parent;
 	struct Scope *scope;
-	struct YASL_Table upval_indices;  // Which order to store the upvalues in the closure
-	struct YASL_Table upval_values;   // What index to look at in the above scope
+	struct SymbolMap upval_indices;  // Which order to store the upvalues in the closure
+	struct SymbolMap upval_values;   // What index to look at in the above scope
 	bool isclosure;
 	bool usedinclosure;
 };
@@ -20,20 +63,22 @@ struct Env {
 struct Scope *scope_new(struct Scope *const scope);
 void scope_del(struct Scope *const scope);
 void scope_del_cur_only(struct Scope *const scope);
+// Returns a new scope, with no parent, that declares the same variables as scope itself.
+struct Scope *scope_copy_cur_only(const struct Scope *const scope);
 
 size_t scope_num_vars_cur_only(const struct Scope *const scope);
 size_t scope_len(const struct Scope *const scope);
-bool scope_contains_cur_only(const struct Scope *const scope, const char *const name);
-bool scope_contains(const struct Scope *const scope, const char *const name);
-int64_t scope_get(const struct Scope *const scope, const char *const name);
-int64_t scope_decl_var(struct Scope *const scope, const char *const name);
-void scope_make_const(struct Scope *const scope, const char *const name);
-
-bool env_contains(const struct Env *env, const char *const name);
-bool env_contains_cur_only(const struct Env *const env, const char *const name);
+bool scope_contains_cur_only(const struct Scope *const scope, const int64_t symbol);
+bool scope_contains(const struct Scope *const scope, const int64_t symbol);
+int64_t scope_get(const struct Scope *const scope, const int64_t symbol);
+int64_t scope_decl_var(struct Scope *const scope, const int64_t symbol);
+void scope_make_const(struct Scope *const scope, const int64_t symbol);
+
+bool env_contains(const struct Env *env, const int64_t symbol);
+bool env_contains_cur_only(const struct Env *const env, const int64_t symbol);
 struct Env *env_new(struct Env *const env);
-int64_t env_resolve_upval_index(struct Env *const env, struct Scope *stack, const char *const name);
-int64_t env_resolve_upval_value(struct Env *const env, const char *const name);
+int64_t env_resolve_upval_index(struct Env *const env, struct Scope *stack, const int64_t symbol);
+int64_t env_resolve_upval_value(struct Env *const env, const int64_t symbol);
 void env_del(struct Env *const env);
 
 #endif
@@ -40,10 +40,13 @@ void lex_val_setnull(struct Lexer *const lex) {
 	lex->buffer.count = 0;
 }
 
+// The value buffer is reused from one token to the next; it is only allocated for the first value, or after lex_val_free.
 static void lex_val_init(struct Lexer *const lex) {
-	lex->buffer.size = 8;
 	lex->buffer.count = 0;
-	lex->buffer.items = (unsigned char *)realloc(lex->buffer.items, lex->buffer.size);
+	if (!lex->buffer.items) {
+		lex->buffer.size = 8;
+		lex->buffer.items = (unsigned char *)malloc(lex->buffer.size);
+	}
 }
 
 void lex_val_free(struct Lexer *const lex) {
@@ -91,13 +94,35 @@ bool lex_eatwhitespace(struct Lexer *const lex) {
 	return false;
 }
 
+#define COMMENT_START '/'
+#define COMMENT_END '/'
+
 static bool lex_eatinlinecomments(struct Lexer *const lex) {
-	if ('#' == lex->c) while (!lxeof(lex->file) && lex_getchar(lex) != '\n') ;
+	if ('#' == lex->c) lex->c = (char)lxskipto(lex->file, '\n');
 	return false;
 }
 
-#define COMMENT_START '/'
-#define COMMENT_END '/'
+static size_t count_newlines(const char *start, const char *const end) {
+	size_t count = 0;
+	while ((start = (const char *)memchr(start, '\n', end - start)) != NULL) {
+		count++;
+		start++;
+	}
+	return count;
+}
+
+/*
+ * Finds the end of the block comment starting at start, returning a pointer to its closing `*` or NULL if it isn't
+ * closed.
+ */
+static const char *find_comment_end(const char *start, const char *const end) {
+	while (start < end && (start = (const char *)memchr(start, '*', end - start)) != NULL) {
+		if (start + 1 < end && start[1] == COMMENT_END) return start;
+		start++;
+	}
+	return NULL;
+}
+
 static bool lex_eatcommentsandwhitespace(struct Lexer * lex) {
 	while (!lxeof(lex->file) && (iswhitespace(lex->c) || lex->c == '#' || lex->c == COMMENT_START)) {
 		// white space
@@ -111,22 +136,23 @@ static bool lex_eatcommentsandwhitespace(struct Lexer * lex) {
 		    long cur = lxtell(lex->file);
 			lex_getchar(lex);
 			if (lex->c == '*') {
-				bool addsemi = false;
+				struct LEXINPUT *const lp = lex->file;
+				const char *const start = lp->data + lp->pos;
+				const char *const end = lp->data + lp->len;
+				const char *const close = find_comment_end(start, end);
 				lex->c = ' ';
-				int c1 = lxgetc(lex->file);
-				int c2 = lxgetc(lex->file);
-				while (!lxeof(lex->file) && (c1 != '*' || c2 != COMMENT_END)) {
-					if (c1 == '\n' || c2 == '\n') addsemi = true;
-					if (c1 == '\n') lex->line++;
-					c1 = c2;
-					c2 = lxgetc(lex->file);
-				}
-				if (lxeof(lex->file)) {
+				if (!close) {
+					lex->line += count_newlines(start, end);
+					lp->pos = lp->len;
+					lxgetc(lp);
 					lex_print_err_syntax(lex,  "Unclosed block comment in line %" PRI_SIZET ".\n", lex->line);
 					lex_error(lex);
 					return true;
 				}
-				if (addsemi && ispotentialend(lex)) {
+				const size_t newlines = count_newlines(start, close);
+				lex->line += newlines;
+				lp->pos = close + 2 - lp->data;
+				if (newlines > 0 && ispotentialend(lex)) {
 					lex->type = T_SEMI;
 					return true;
 				}
@@ -160,7 +186,6 @@ static bool lex_eatop(struct Lexer *const lex) {
 	last = YASLToken_ThreeChars(c1, c2, c3);
 	if (last != T_UNKNOWN) {
 		lex->type = last;
-		lex_val_free(lex);
 		return true;
 	}
 	lxseek(lex->file, cur_two, SEEK_SET);
@@ -169,7 +194,6 @@ static bool lex_eatop(struct Lexer *const lex) {
 	last = YASLToken_TwoChars(c1, c2);
 	if (last != T_UNKNOWN) {
 		lex->type = last;
-		lex_val_free(lex);
 		return true;
 	}
 	lxseek(lex->file, cur_one, SEEK_SET);
@@ -200,7 +224,6 @@ static bool lex_eatop(struct Lexer *const lex) {
 	}
 	if (last != T_UNKNOWN) {
 		lex->type = last;
-		lex_val_free(lex);
 		return true;
 	}
 	return false;
@@ -308,13 +331,18 @@ static bool lex_eatnumber(struct Lexer *const lex) {
 }
 
 static void lex_eatid_fill(struct Lexer *const lex) {
-    long cur;
-	do {
-		lex_val_append(lex, lex->c);
-		cur = lxtell(lex->file);
+	struct LEXINPUT *const lp = lex->file;
+	const char *const start = lp->data + lp->pos - 1;
+	const char *const end = lp->data + lp->len;
+	const char *curr = start + 1;
+	while (curr < end && isyaslid(*curr)) curr++;
+	YASL_ByteBuffer_extend(&lex->buffer, (const unsigned char *)start, curr - start);
+	lp->pos = curr - lp->data;
+	if (curr == end) {
 		lex_getchar(lex);
-	} while (!lxeof(lex->file) && isyaslid(lex->c));
-    if (!lxeof(lex->file)) lxseek(lex->file, cur, SEEK_SET);
+	} else {
+		lex->c = *curr;
+	}
 }
 static bool lex_eatid(struct Lexer *const lex) {
 	if (isyaslidstart(lex->c)) {                           // identifiers and keywords
@@ -376,6 +404,22 @@ error:
 	return true;
 }
 
+/*
+ * Appends the current character, and the run of characters after it up to the next delimiter, escape, placeholder or
+ * newline. The last character appended becomes the current one.
+ */
+static void lex_eatstring_run(struct Lexer *const lex, char delim) {
+	struct LEXINPUT *const lp = lex->file;
+	const char *const start = lp->data + lp->pos - 1;
+	const char *const end = lp->data + lp->len;
+	const char *curr = start + 1;
+	while (curr < end && *curr != delim && *curr != ESCAPE_CHAR && *curr != INTERP_STR_PLACEHOLDER && *curr != '\n') {
+		curr++;
+	}
+	YASL_ByteBuffer_extend(&lex->buffer, (const unsigned char *)start, curr - start);
+	lp->pos = curr - lp->data;
+}
+
 static bool lex_eatstring_nextchar(struct Lexer *const lex, char delim) {
 	if (lex->c == ESCAPE_CHAR) {
 		lex_getchar(lex);
@@ -383,7 +427,7 @@ static bool lex_eatstring_nextchar(struct Lexer *const lex, char delim) {
 			return true;
 		}
 	} else {
-		lex_val_append(lex, lex->c);
+		lex_eatstring_run(lex, delim);
 	}
 	return false;
 }
@@ -467,12 +511,15 @@ static bool lex_eatrawstring(struct Lexer *const lex) {
 		lex_val_init(lex);
 		lex->type = T_STR;
 
+		struct LEXINPUT *const lp = lex->file;
+		const char *const start = lp->data + lp->pos;
+		const char *const end = lp->data + lp->len;
+		const char *close = start < end ? (const char *)memchr(start, RAW_STR_DELIM, end - start) : NULL;
+		if (!close) close = end;
+		lex->line += count_newlines(start, close);
+		YASL_ByteBuffer_extend(&lex->buffer, (const unsigned char *)start, close - start);
+		lp->pos = close - lp->data;
 		lex_getchar(lex);
-		while (lex->c != RAW_STR_DELIM && !lxeof(lex->file)) {
-			if (lex->c == '\n') lex->line++;
-			lex_val_append(lex, lex->c);
-			lex_getchar(lex);
-		}
 
 		if (lxeof(lex->file)) {
 			lex_print_err_syntax(lex, "Unclosed string literal in line %" PRI_SIZET ".\n", lex->line);
@@ -489,7 +536,7 @@ static bool lex_eatrawstring(struct Lexer *const lex) {
 
 void gettok(struct Lexer *const lex) {
 	YASL_LEX_DEBUG_LOG("getting token from line %" PRI_SIZET "\n", lex->line);
-	lex_val_setnull(lex);
+	lex->buffer.count = 0;
 	lex_getchar(lex);
 
 	// whitespace and comments.
@@ -502,7 +549,6 @@ void gettok(struct Lexer *const lex) {
 			return;
 		}
 		lex->type = T_EOF;
-		lex_val_setnull(lex);
 		return;
 	}
 
@@ -635,8 +681,6 @@ static bool matches_keyword(struct Lexer *const lex, const char *string) {
 
 static void set_keyword(struct Lexer *const lex, enum Token type) {
 	lex->type = type;
-	lex_val_free(lex);
-	lex_val_setnull(lex);
 }
 
 void YASLKeywords(struct Lexer *const lex) {
@@ -681,6 +725,7 @@ const char *YASL_TOKEN_NAMES[] = {
 };
 
 void lex_cleanup(struct Lexer *const lex) {
+	lex_val_free(lex);
 	lxclose(lex->file);
 	io_cleanup(&lex->err);
 }
@@ -1,15 +1,70 @@
 #ifndef YASL_LEXINPUT_H_
 #define YASL_LEXINPUT_H_
 
+#include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 
-struct LEXINPUT;
-struct LEXINPUT *lexinput_new_file(FILE *const lp);
+#include "util/yasl_filemap.h"
+
+/*
+ * Source being lexed, as one contiguous buffer. Files are mapped into memory where possible; other sources are
+ * copied. The lexer reads it a character at a time through the functions below, which mirror fgetc, ftell, fseek and
+ * feof, or scans data directly for long runs such as comments and string bodies.
+ */
+struct LEXINPUT {
+	const char *data;
+	size_t len;
+	size_t pos;
+	bool iseof;
+	struct YASL_FileMap map;
+	char *owned;  // OWN, if data isn't mapped
+};
+
+struct LEXINPUT *lexinput_new_file(FILE *const fp);
 struct LEXINPUT *lexinput_new_bb(const char *const buf, const size_t len);
-int lxgetc(struct LEXINPUT *const lp);
-int lxtell(struct LEXINPUT *const lp);
-int lxseek(struct LEXINPUT *const lp, const int w, const int cmd);
 int lxclose(struct LEXINPUT *const lp);
-int lxeof(struct LEXINPUT *const lp);
+
+inline int lxgetc(struct LEXINPUT *const lp) {
+	if (lp->pos >= lp->len) {
+		lp->iseof = true;
+		return -1;
+	}
+	return (unsigned char)lp->data[lp->pos++];
+}
+
+inline int lxtell(struct LEXINPUT *const lp) {
+	return (int)lp->pos;
+}
+
+inline int lxseek(struct LEXINPUT *const lp, const int w, const int cmd) {
+	if (cmd == SEEK_SET) {
+		lp->pos = w;
+	} else if (cmd == SEEK_CUR) {
+		lp->pos += w;
+	} else if (cmd == SEEK_END) {
+		lp->pos = lp->len + w;
+	}
+	lp->iseof = false;
+	return 0;
+}
+
+inline int lxeof(struct LEXINPUT *const lp) {
+	return lp->pos >= lp->len && lp->iseof;
+}
+
+/*
+ * Moves past the next occurrence of c, returning c, or to the end of the input, returning -1 as lxgetc does.
+ */
+inline int lxskipto(struct LEXINPUT *const lp, const char c) {
+	const char *found = lp->pos < lp->len ? (const char *)memchr(lp->data + lp->pos, c, lp->len - lp->pos) : NULL;
+	if (!found) {
+		lp->pos = lp->len;
+		lp->iseof = true;
+		return -1;
+	}
+	lp->pos = found - lp->data + 1;
+	return (unsigned char)c;
+}
 
 #endif
@@ -7,6 +7,8 @@
 #include "ast.h"
 #include "common/debug.h"
 #include "middleend.h"
+#include "util/yasl_float.h"
+#include "util/yasl_int.h"
 #include "yasl_conf.h"
 #include "yasl_error.h"
 #include "yasl_include.h"
@@ -63,40 +65,6 @@ YASL_FORMAT_CHECK static void parser_print_err(struct Parser *parser, const char
 
 #define parser_print_err_syntax(parser, format, ...) parser_print_err(parser, "SyntaxError: " format, __VA_ARGS__)
 
-void parser_register_node(struct Parser *parser, struct Node *node) {
-	if (!parser->head) {
-		parser->head = node;
-	} else {
-		parser->tail->next = node;
-	}
-	parser->tail = node;
-}
-
-void parser_unregister_node(struct Parser *parser, struct Node *node) {
-	if (!parser->head)
-		return;
-
-	if (parser->head == node) {
-		parser->head = parser->head->next;
-		node->next = NULL;
-		return;
-	}
-
-	struct Node *prev = parser->head;
-	struct Node *curr = prev->next;
-	while (curr) {
-		if (curr == node) {
-			prev->next = curr->next;
-			node->next = NULL;
-			if (node == parser->tail)
-				parser->tail = prev;
-			break;
-		}
-		prev = curr;
-		curr = curr->next;
-	}
-}
-
 int peof(const struct Parser *const parser) {
 	return parser->lex.type == T_EOF;
 }
@@ -122,14 +90,12 @@ static inline enum Token curtok(const struct Parser *const parser) {
 }
 
 void parser_cleanup(struct Parser *const parser) {
-	node_del(parser->head);
+	yasl_arena_free(&parser->arena);
 	lex_cleanup(&parser->lex);
 }
 
 static YASL_NORETURN void handle_error(struct Parser *const parser) {
 	parser->status = YASL_SYNTAX_ERROR;
-	lex_val_free(&parser->lex);
-	lex_val_setnull(&parser->lex);
 
 	while (parser->lex.c != '\n' && !lxeof(parser->lex.file)) {
 		lex_getchar(&parser->lex);
@@ -148,7 +114,6 @@ enum Token eattok(struct Parser *const parser, const enum Token token) {
 			parser->status = YASL_SYNTAX_ERROR;
 		}
 		while (!TOKEN_MATCHES(parser, T_SEMI, T_EOF)) {
-			lex_val_free(&parser->lex);
 			gettok(&parser->lex);
 		}
 		return T_UNKNOWN;
@@ -158,8 +123,16 @@ enum Token eattok(struct Parser *const parser, const enum Token token) {
 	return token;
 }
 
+/*
+ * Copies the value of the current token into the arena, since the lexer reuses its buffer for the next token.
+ */
+static char *parser_copy_val(struct Parser *const parser) {
+	return yasl_arena_strdup(&parser->arena, lex_val_get(&parser->lex), parser->lex.buffer.count);
+}
+
 static char *eatname(struct Parser *const parser) {
-	char *tmp = lex_val_get(&parser->lex);
+	const char *val = lex_val_get(&parser->lex);
+	char *tmp = curtok(parser) == T_ID ? yasl_arena_strdup(&parser->arena, val, strlen(val)) : NULL;
 	eattok(parser, T_ID);
 	if (parser->status)
 		handle_error(parser);
@@ -210,8 +183,6 @@ struct Node *parse_assign_or_exprstmt(struct Parser *const parser) {
 static bool isfndecl(struct Parser *const parser) {
 	int curr = lxtell(parser->lex.file);
 	eattok(parser, T_FN);
-	lex_val_free(&parser->lex);
-	lex_val_setnull(&parser->lex);
 	bool result = TOKEN_MATCHES(parser, T_ID);
 	lxseek(parser->lex.file, curr, SEEK_SET);
 	parser->lex.type = T_FN;
@@ -224,8 +195,6 @@ static bool isfndecl(struct Parser *const parser) {
 static bool isemptyvargs(struct Parser *const parser) {
 	int curr = lxtell(parser->lex.file);
 	eattok(parser, T_LPAR);
-	lex_val_free(&parser->lex);
-	lex_val_setnull(&parser->lex);
 	bool result = TOKEN_MATCHES(parser, T_RPAR);
 	lxseek(parser->lex.file, curr, SEEK_SET);
 	parser->lex.type = T_LPAR;
@@ -238,7 +207,6 @@ static bool isemptyvargs(struct Parser *const parser) {
 static bool isconstfndecl(struct Parser *const parser) {
 	long curr = lxtell(parser->lex.file);
 	eattok(parser, T_CONST);
-	lex_val_free(&parser->lex);
 	bool result = TOKEN_MATCHES(parser, T_FN);
 	lxseek(parser->lex.file, curr, SEEK_SET);
 	parser->lex.type = T_CONST;
@@ -393,8 +361,14 @@ static struct Node *parse_return_vals(struct Parser *const parser) {
 	return body;
 }
 
-static struct Node *parse_fn_body(struct Parser *const parser, bool collect_rest_params) {
-	struct Node *body = new_Body(parser, parserline(parser));
+/*
+ * Parses the body of a function, whose parameter list started at source on the given line. A body in braces records
+ * its source, from the start of the parameter list to the closing brace, so that the compiler can leave it to be
+ * compiled when the function is first called.
+ */
+static struct Node *parse_fn_body(struct Parser *const parser, bool collect_rest_params, const char *source,
+				  const size_t line) {
+	struct Node *body = new_Body(parser, line);
 	if (collect_rest_params)
 		body_append(parser, &body, new_CollectRestParams(parser, parserline(parser)));
 	if (matcheattok(parser, T_RIGHT_ARR)) {
@@ -426,6 +400,11 @@ static struct Node *parse_fn_body(struct Parser *const parser, bool collect_rest
 			body_append(parser, &body, parse_program(parser));
 			eattok(parser, T_SEMI);
 		}
+		if (curtok(parser) == T_RBRC) {
+			const struct LEXINPUT *const lp = parser->lex.file;
+			body->value.sval.str = (char *)source;
+			body->value.sval.len = lp->data + lp->pos - source;
+		}
 		eattok(parser, T_RBRC);
 	}
 
@@ -459,6 +438,22 @@ static struct Node *parse_function_params(struct Parser *const parser, bool *col
 	return block;
 }
 
+/*
+ * Parses the parameter list and body of a function, starting at the `(`. Returns the parameters.
+ */
+static struct Node *parse_fn_params_and_body(struct Parser *const parser, struct Node **body) {
+	// The lexer has just read the `(`.
+	const char *const source = parser->lex.file->data + parser->lex.file->pos - 1;
+	const size_t line = parserline(parser);
+	eattok(parser, T_LPAR);
+	bool collect_rest_params = false;
+	struct Node *block = parse_function_params(parser, &collect_rest_params);
+	eattok(parser, T_RPAR);
+
+	*body = parse_fn_body(parser, collect_rest_params, source, line);
+	return block;
+}
+
 static struct Node *parse_return(struct Parser *const parser) {
 	size_t line = parserline(parser);
 	eattok(parser, T_RET);
@@ -479,21 +474,13 @@ static struct Node *parse_fn(struct Parser *const parser) {
 
 		struct Node *index = new_String(parser, name, name_len, line);
 
-		eattok(parser, T_LPAR);
-		bool collect_rest_params = false;
-		struct Node *block = parse_function_params(parser, &collect_rest_params);
-		eattok(parser, T_RPAR);
-
-		struct Node *body = parse_fn_body(parser, collect_rest_params);
+		struct Node *body;
+		struct Node *block = parse_fn_params_and_body(parser, &body);
 
 		return new_Set(parser, collection, index, new_FnDecl(parser, block, body, NULL, line), line);
 	}
-	eattok(parser, T_LPAR);
-	bool collect_rest_params = false;
-	struct Node *block = parse_function_params(parser, &collect_rest_params);
-	eattok(parser, T_RPAR);
-
-	struct Node *body = parse_fn_body(parser, collect_rest_params);
+	struct Node *body;
+	struct Node *block = parse_fn_params_and_body(parser, &body);
 
 	return new_Let(parser, new_FnDecl(parser, block, body, name, line), name, line);
 	// TODO Fix this ^
@@ -505,12 +492,8 @@ static struct Node *parse_const_fn(struct Parser *const parser) {
 	eattok(parser, T_FN);
 	size_t line = parserline(parser);
 	char *name = eatname(parser);
-	eattok(parser, T_LPAR);
-	bool collect_rest_params = false;
-	struct Node *block = parse_function_params(parser, &collect_rest_params);
-	eattok(parser, T_RPAR);
-
-	struct Node *body = parse_fn_body(parser, collect_rest_params);
+	struct Node *body;
+	struct Node *block = parse_fn_params_and_body(parser, &body);
 
 	// TODO fix this
 	return new_Const(parser, new_FnDecl(parser, block, body, name, line), name, line);
@@ -735,7 +718,6 @@ static struct Node *parse_primitivepattern(struct Parser *const parser) {
 			parser_print_err_syntax(parser, "Invalid pattern: %s (line %" PRI_SIZET ").\n", name, line);
 			handle_error(parser);
 		}
-		free(name);
 		return n;
 	}
 	default:
@@ -1246,42 +1228,56 @@ static struct Node *parse_lambda(struct Parser *const parser) {
 	size_t line = parserline(parser);
 
 	eattok(parser, T_FN);
-	eattok(parser, T_LPAR);
-	bool collect_rest_params = false;
-	struct Node *block = parse_function_params(parser, &collect_rest_params);
-	eattok(parser, T_RPAR);
-	struct Node *body = parse_fn_body(parser, collect_rest_params);
+	struct Node *body;
+	struct Node *block = parse_fn_params_and_body(parser, &body);
 
 	return new_FnDecl(parser, block, body, NULL, line);
 }
 
+struct Node *parse_fn_source(struct Parser *const parser) {
+	if (setjmp(parser->env)) {
+		return NULL;
+	}
+	gettok(&parser->lex);
+	const size_t line = parserline(parser);
+	struct Node *body;
+	struct Node *block = parse_fn_params_and_body(parser, &body);
+	return parser->status ? NULL : new_FnDecl(parser, block, body, NULL, line);
+}
+
 static yasl_float get_float(char *buffer) {
+	yasl_float result;
+	if (float64_parse(buffer, strlen(buffer), &result)) {
+		return result;
+	}
 	return strtod(buffer, (char **) NULL);
 }
 
 static struct Node *parse_float(struct Parser *const parser) {
 	YASL_PARSE_DEBUG_LOG("%s\n", "Parsing float");
 	struct Node *cur_node = new_Float(parser, get_float(lex_val_get(&parser->lex)), parserline(parser));
-	lex_val_free(&parser->lex);
 	eattok(parser, T_FLOAT);
 	return cur_node;
 }
 
 static yasl_int get_int(char *buffer) {
-	if (strlen(buffer) < 2) {
-		return strtoll(buffer, (char **) NULL, 10);
+	const size_t len = strlen(buffer);
+	yasl_int result = 0;
+	if (len < 2) {
+		int64_parse(buffer, len, 10, &result);
+		return result;
 	}
 	switch (buffer[1]) {
-	case 'x': return strtoll(buffer + 2, (char **) NULL, 16);
-	case 'b': return strtoll(buffer + 2, (char **) NULL, 2);
-	default: return strtoll(buffer, (char **) NULL, 10);
+	case 'x': int64_parse(buffer + 2, len - 2, 16, &result); break;
+	case 'b': int64_parse(buffer + 2, len - 2, 2, &result); break;
+	default: int64_parse(buffer, len, 10, &result); break;
 	}
+	return result;
 }
 
 static struct Node *parse_integer(struct Parser *const parser) {
 	YASL_PARSE_DEBUG_LOG("%s\n", "Parsing int");
 	struct Node *cur_node = new_Integer(parser, get_int(lex_val_get(&parser->lex)), parserline(parser));
-	lex_val_free(&parser->lex);
 	eattok(parser, T_INT);
 	return cur_node;
 }
@@ -1289,14 +1285,13 @@ static struct Node *parse_integer(struct Parser *const parser) {
 static struct Node *parse_boolean(struct Parser *const parser) {
 	YASL_PARSE_DEBUG_LOG("%s\n", "Parsing bool");
 	struct Node *cur_node = new_Boolean(parser, !strcmp(lex_val_get(&parser->lex), "true"), parserline(parser));
-	lex_val_free(&parser->lex);
 	eattok(parser, T_BOOL);
 	return cur_node;
 }
 
 static struct Node *parse_string(struct Parser *const parser) {
 	YASL_PARSE_DEBUG_LOG("%s\n", "Parsing str");
-	struct Node *cur_node = new_String(parser, lex_val_get(&parser->lex), parser->lex.buffer.count, parserline(parser));
+	struct Node *cur_node = new_String(parser, parser_copy_val(parser), parser->lex.buffer.count, parserline(parser));
 
 	// interpolated strings
 	while (parser->lex.mode == L_INTERP) {
@@ -1333,7 +1328,7 @@ static struct Node *parse_string(struct Parser *const parser) {
 		if (parser->lex.status) {
 			handle_error(parser);
 		};
-		struct Node *str = new_String(parser, lex_val_get(&parser->lex), parser->lex.buffer.count, parserline(parser));
+		struct Node *str = new_String(parser, parser_copy_val(parser), parser->lex.buffer.count, parserline(parser));
 		cur_node = new_BinOp(parser, T_TILDE, cur_node, str, parserline(parser));
 	}
 
@@ -5,6 +5,7 @@
 #include "lexer.h"
 #include "yapp.h"
 #include "ast.h"
+#include "yasl_arena.h"
 
 #define T1(p, a) (curtok(p) == a)
 #define T2(p, a, b) T1(p, a) || T1(p, b)
@@ -18,16 +19,14 @@
 	.lex = NEW_LEXER(fp),\
 	.status = YASL_SUCCESS,\
 	.allow_echo = true,\
-	.head = NULL,\
-	.tail = NULL,\
+	.arena = NEW_ARENA(),\
 })
 
 struct Parser {
 	struct Lexer lex; /* OWN */
 	int status;
 	bool allow_echo;
-	struct Node *head;
-	struct Node *tail;
+	struct YASL_Arena arena; /* OWN */  // nodes and the strings they hold, freed together once compiled
 	jmp_buf env;
 };
 
@@ -36,5 +35,10 @@ size_t parserline(const struct Parser *const parser);
 void parser_cleanup(struct Parser *const parser);
 enum Token eattok(struct Parser *const parser, const enum Token token);
 struct Node *parse(struct Parser *const parser);
+/*
+ * Parses a function from its parameter list to the end of its body, as recorded in the Body of a FnDecl. Returns the
+ * FnDecl, or NULL on a syntax error.
+ */
+struct Node *parse_fn_source(struct Parser *const parser);
 
 #endif
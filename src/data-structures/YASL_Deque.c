@@ -0,0 +1,76 @@
+#include "YASL_Deque.h"
+
+#include <string.h>
+
+#include "debug.h"
+#include "interpreter/VM.h"
+
+struct YASL_Deque *YASL_Deque_new(void) {
+	struct YASL_Deque *dq = (struct YASL_Deque *)malloc(sizeof(struct YASL_Deque));
+	dq->size = DEQUE_BASESIZE;
+	dq->head = 0;
+	dq->count = 0;
+	dq->items = (struct YASL_Object *)malloc(sizeof(struct YASL_Object) * dq->size);
+	return dq;
+}
+
+void YASL_Deque_del(struct YASL_State *S, void *ptr) {
+	YASL_UNUSED(S);
+	struct YASL_Deque *dq = (struct YASL_Deque *)ptr;
+	for (size_t i = 0; i < dq->count; i++) dec_ref(YASL_Deque_at(dq, i));
+	free(dq->items);
+	free(dq);
+}
+
+size_t YASL_Deque_len(const struct YASL_Deque *const dq) {
+	return dq->count;
+}
+
+/*
+ * Doubles the size of the buffer. Items that wrapped around the end of the old buffer are moved to just after it, so
+ * that the head does not need to move.
+ */
+static void dq_resize_up(struct YASL_Deque *const dq) {
+	const size_t old_size = dq->size;
+	dq->size *= 2;
+	dq->items = (struct YASL_Object *)realloc(dq->items, dq->size * sizeof(struct YASL_Object));
+	if (dq->head + dq->count > old_size) {
+		memcpy(dq->items + old_size, dq->items, (dq->head + dq->count - old_size) * sizeof(struct YASL_Object));
+	}
+}
+
+void YASL_Deque_push(struct YASL_Deque *const dq, struct YASL_Object value) {
+	if (dq->count >= dq->size) dq_resize_up(dq);
+	*YASL_Deque_at(dq, dq->count) = value;
+	dq->count++;
+	inc_ref(&value);
+}
+
+void YASL_Deque_pushleft(struct YASL_Deque *const dq, struct YASL_Object value) {
+	if (dq->count >= dq->size) dq_resize_up(dq);
+	dq->head = (dq->head - 1) & (dq->size - 1);
+	dq->items[dq->head] = value;
+	dq->count++;
+	inc_ref(&value);
+}
+
+struct YASL_Object YASL_Deque_pop(struct YASL_Deque *const dq) {
+	YASL_ASSERT(dq->count > 0, "cannot pop from empty deque.");
+	return *YASL_Deque_at(dq, --dq->count);
+}
+
+struct YASL_Object YASL_Deque_popleft(struct YASL_Deque *const dq) {
+	YASL_ASSERT(dq->count > 0, "cannot pop from empty deque.");
+	struct YASL_Object value = dq->items[dq->head];
+	dq->head = (dq->head + 1) & (dq->size - 1);
+	dq->count--;
+	return value;
+}
+
+void YASL_Deque_clear(struct VM *vm, struct YASL_Deque *const dq) {
+	for (size_t i = 0; i < dq->count; i++) vm_dec_ref(vm, YASL_Deque_at(dq, i));
+	dq->head = 0;
+	dq->count = 0;
+	dq->size = DEQUE_BASESIZE;
+	dq->items = (struct YASL_Object *)realloc(dq->items, sizeof(struct YASL_Object) * dq->size);
+}
@@ -0,0 +1,35 @@
+#ifndef YASL_YASL_DEQUE_H_
+#define YASL_YASL_DEQUE_H_
+
+#include "interpreter/YASL_Object.h"
+
+#define DEQUE_BASESIZE 4
+
+struct VM;
+
+/*
+ * Items are stored in a circular buffer whose size is always a power of 2, so that indices can be wrapped with a mask.
+ */
+#define YASL_Deque_at(dq, i) ((dq)->items + (((dq)->head + (i)) & ((dq)->size - 1)))
+
+#define FOR_DEQUE(i, name, dq) struct YASL_Object name; for (size_t i = 0; i < (dq)->count && (name = *YASL_Deque_at(dq, i), 1); i++)
+
+struct YASL_Deque {
+	size_t size;
+	size_t head;
+	size_t count;
+	struct YASL_Object *items;
+};
+
+struct YASL_Deque *YASL_Deque_new(void);
+void YASL_Deque_del(struct YASL_State *S, void *dq);
+size_t YASL_Deque_len(const struct YASL_Deque *const dq);
+void YASL_Deque_push(struct YASL_Deque *const dq, struct YASL_Object value);
+void YASL_Deque_pushleft(struct YASL_Deque *const dq, struct YASL_Object value);
+// The caller takes ownership of the reference held by the deque.
+struct YASL_Object YASL_Deque_pop(struct YASL_Deque *const dq);
+// The caller takes ownership of the reference held by the deque.
+struct YASL_Object YASL_Deque_popleft(struct YASL_Deque *const dq);
+void YASL_Deque_clear(struct VM *vm, struct YASL_Deque *const dq);
+
+#endif
@@ -10,8 +10,14 @@
 #include "YASL_List.h"
 #include "interpreter/YASL_Object.h"
 #include "YASL_ByteBuffer.h"
+#include "YASL_StringSet.h"
+#include "util/yasl_ascii.h"
+#include "util/yasl_float.h"
+#include "util/yasl_int.h"
+#include "util/yasl_utf8.h"
 
 struct YASL_String *vm_lookup_interned_str(struct VM *vm, const char *chars, const size_t size);
+struct YASL_String *vm_lookup_interned_str_take(struct VM *vm, const char *mem, const size_t size);
 
 size_t YASL_String_len(const struct YASL_String *const str) {
 	return LString_len(str->s);
@@ -47,9 +53,8 @@ struct YASL_String *YASL_String_new_substring(struct VM *vm, const struct YASL_S
 }
 
 struct YASL_String *YASL_String_new_copy(struct VM *vm, const char *const ptr, const size_t base_size) {
-	struct YASL_String *string = vm_lookup_interned_str(vm, ptr, base_size);
-	if (string) {
-		return string;
+	if (base_size <= YASL_STRING_INTERN_MAX_LEN) {
+		return vm_lookup_interned_str(vm, ptr, base_size);
 	}
 
 	return YASL_String_new_copy_unbound(ptr, base_size);
@@ -63,10 +68,8 @@ struct YASL_String *YASL_String_new_copy_unbound(const char *const ptr, const si
 }
 
 struct YASL_String *YASL_String_new_take(struct VM *vm, const char *const mem, const size_t base_size) {
-	struct YASL_String *string = vm_lookup_interned_str(vm, mem, base_size);
-	if (string) {
-		free((char *)mem);
-		return string;
+	if (base_size <= YASL_STRING_INTERN_MAX_LEN) {
+		return vm_lookup_interned_str_take(vm, mem, base_size);
 	}
 
 	return YASL_String_new_take_unbound(mem, base_size);
@@ -76,21 +79,28 @@ struct YASL_String *YASL_String_new_take_unbound(const char *const mem, const si
 	struct YASL_String *str = (struct YASL_String *) malloc(sizeof(struct YASL_String));
 	LString_init(&str->s, (char *)mem, base_size);
 	str->rc = NEW_RC();
+	str->utf8 = NULL;
 	return str;
 }
 
+static void str_utf8_index_del(struct YASL_UTF8Index *index);
+
 void str_del_data(struct YASL_String *const str) {
-	free((void *) CHARS(str));
+	if (!str->rc.is_borrowed) free((void *) CHARS(str));
+	str_utf8_index_del(str->utf8);
 }
 
 void str_del_rc(struct YASL_String *const str) {
+	if (str->rc.is_interned) {
+		YASL_StringSet_rm(str);
+	}
 	free(str);
 }
 
 void str_del(struct YASL_String *const str) {
 	// YASL_ASSERT(CHARS(str)[LEN(str)] == '\0', "expected a nul-terminator");
 	str_del_data(str);
-	free(str);
+	str_del_rc(str);
 }
 
 
@@ -101,187 +111,177 @@ void str_del(struct YASL_String *const str) {
  ********************************************************************************/
 
 
-bool isvaliddouble(const char *str) {
-	const size_t len = strlen(str);
-	bool hasdot = false;
-	bool hase = false;
-	for (size_t i = 0; i < len; i++) {
-		switch (str[i]) {
-		case '0':
-		case '1':
-		case '2':
-		case '3':
-		case '4':
-		case '5':
-		case '6':
-		case '7':
-		case '8':
-		case '9':
-			break;
-		case '.':
-			if (hase || hasdot) return false;
-			hasdot = true;
-			break;
-		case 'e':
-		case 'E':
-			if (hase) return false;
-			hase = true;
-			break;
-		case '-':
-		case '+':
-			if (i > 0 && (str[i-1] == 'e' || str[i-1] == 'E')) break;
-			return false;
-		default:
-			return false;
-
+#define BYTESET_TEST(set, c) ((set)[(c) / (8 * sizeof(size_t))] & ((size_t)1 << ((c) % (8 * sizeof(size_t)))))
+#define BYTESET_ADD(set, c) ((set)[(c) / (8 * sizeof(size_t))] |= ((size_t)1 << ((c) % (8 * sizeof(size_t)))))
+
+/*
+ * Finds the critical factorization of the needle, using either the normal or reversed byte order. Returns the start
+ * of the maximal suffix, minus 1, and sets `period` to the period of that suffix.
+ */
+static size_t str_max_suffix(const unsigned char *needle, const size_t len, size_t *period, const bool reversed) {
+	size_t ms = (size_t)-1;
+	size_t j = 0;
+	size_t k = 1;
+	size_t p = 1;
+	while (j + k < len) {
+		const unsigned char a = needle[ms + k];
+		const unsigned char b = needle[j + k];
+		if (a == b) {
+			if (k == p) {
+				j += p;
+				k = 1;
+			} else {
+				k++;
+			}
+		} else if (reversed ? a < b : a > b) {
+			j += k;
+			k = 1;
+			p = j - ms;
+		} else {
+			ms = j++;
+			k = p = 1;
 		}
 	}
-	return hasdot && isdigit((int)str[len-1]) && isdigit((int)str[0]);
+	*period = p;
+	return ms;
 }
 
-int64_t str_find_index(const struct YASL_String *const haystack, const struct YASL_String *const needle, yasl_int start) {
-	// TODO: implement non-naive algorithm for string search.
-	const yasl_int haystack_len = YASL_String_len(haystack);
-	const yasl_int needle_len = YASL_String_len(needle);
-	if (haystack_len < needle_len) return -1;
-	yasl_int i = start;
-	const char *hayStr = YASL_String_chars(haystack);
-	const char *needleStr = YASL_String_chars(needle);
-	while (i <= haystack_len - needle_len) {
-		if (!memcmp(hayStr + i, needleStr, needle_len)) return i;
-		i++;
+void str_searcher_init(struct StrSearcher *searcher, const char *needle, const size_t len) {
+	const unsigned char *n = (const unsigned char *)needle;
+	searcher->needle = n;
+	searcher->len = len;
+	if (len < 2) return;
+
+	memset(searcher->byteset, 0, sizeof(searcher->byteset));
+	for (size_t i = 0; i < len; i++) {
+		BYTESET_ADD(searcher->byteset, n[i]);
+		searcher->shift[n[i]] = i + 1;
 	}
-	return -1;
+
+	size_t p, p_rev;
+	size_t ms = str_max_suffix(n, len, &p, false);
+	const size_t ms_rev = str_max_suffix(n, len, &p_rev, true);
+	if (ms_rev + 1 > ms + 1) {
+		ms = ms_rev;
+		p = p_rev;
+	}
+
+	if (memcmp(n, n + p, ms + 1)) {
+		/* Not periodic: we can shift past the whole mismatch, and never need to remember a matched prefix. */
+		const size_t left = ms + 1;
+		const size_t right = len - ms - 1;
+		searcher->period = (left > right ? left : right) + 1;
+		searcher->memory = 0;
+	} else {
+		searcher->period = p;
+		searcher->memory = len - p;
+	}
+	searcher->ms = ms;
+}
+
+const char *str_searcher_find(const struct StrSearcher *searcher, const char *haystack, const size_t len) {
+	const size_t needle_len = searcher->len;
+	if (needle_len == 0) return haystack;
+	if (needle_len > len) return NULL;
+	if (needle_len == 1) return (const char *)memchr(haystack, *searcher->needle, len);
+
+	const unsigned char *n = searcher->needle;
+	const unsigned char *h = (const unsigned char *)haystack;
+	const unsigned char *const end = h + len;
+	const size_t ms = searcher->ms;
+	size_t mem = 0;
+	while ((size_t)(end - h) >= needle_len) {
+		/* Check the last byte first, skipping ahead as in Boyer-Moore if it can't be part of a match here. */
+		const unsigned char last = h[needle_len - 1];
+		if (!BYTESET_TEST(searcher->byteset, last)) {
+			h += needle_len;
+			mem = 0;
+			continue;
+		}
+		size_t k = needle_len - searcher->shift[last];
+		if (k) {
+			h += k < mem ? mem : k;
+			mem = 0;
+			continue;
+		}
+
+		/* Compare the right half, then the left half. */
+		for (k = ms + 1 > mem ? ms + 1 : mem; k < needle_len && n[k] == h[k]; k++);
+		if (k < needle_len) {
+			h += k - ms;
+			mem = 0;
+			continue;
+		}
+		for (k = ms + 1; k > mem && n[k - 1] == h[k - 1]; k--);
+		if (k <= mem) return (const char *)h;
+		h += searcher->period;
+		mem = searcher->memory;
+	}
+	return NULL;
 }
 
-static yasl_float parsedouble(const char *str, bool *ok) {
-	*ok = true;
-	if (!strcmp(str, "inf") || !strcmp(str, "+inf")) return INFINITY;
-	else if (!strcmp(str, "-inf")) return -INFINITY;
-	else if (str[0] == '-' && isvaliddouble(str+1))
-		return -strtod(str+1, NULL);
-	else if (str[0] == '+' && isvaliddouble(str+1))
-		return +strtod(str+1, NULL);
-	else if (isvaliddouble(str))
-		return strtod(str, NULL);
-	*ok = false;
-	return NAN;
+int64_t str_find_index(const struct YASL_String *const haystack, const struct YASL_String *const needle, yasl_int start) {
+	const size_t haystack_len = YASL_String_len(haystack);
+	if ((size_t)start > haystack_len) return -1;
+	struct StrSearcher searcher;
+	str_searcher_init(&searcher, YASL_String_chars(needle), YASL_String_len(needle));
+	const char *found = str_searcher_find(&searcher, YASL_String_chars(haystack) + start, haystack_len - start);
+	return found ? found - YASL_String_chars(haystack) : -1;
 }
 
-static yasl_int parseint64(const char *str, bool *ok) {
-	yasl_int result;
-	size_t len = strlen(str);
-	char *end;
-	if (len > 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
-		result = strtoll(str + 2, &end, 16);
-	} else if (len > 2 && str[0] == '0' && (str[1] == 'b' || str[1] == 'B')) {
-		result = strtoll(str + 2, &end, 2);
-	} else {
-		result = strtoll(str, &end, 10);
+static bool parseint64(const char *chars, const size_t len, yasl_int *result) {
+	int base = 10;
+	size_t i = 0;
+	if (len > 2 && chars[0] == '0' && (chars[1] == 'x' || chars[1] == 'X')) {
+		base = 16;
+		i = 2;
+	} else if (len > 2 && chars[0] == '0' && (chars[1] == 'b' || chars[1] == 'B')) {
+		base = 2;
+		i = 2;
 	}
-	*ok = str + len == end;
-	return str + len == end ? result : 0;
+	while (base != 10 && i < len && chars[i] == '_') {
+		i++;
+	}
+	return int64_parse(chars + i, len - i, base, result);
 }
 
 yasl_float YASL_String_tofloat(const char *chars, const size_t len) {
-	char *buffer = (char *)malloc(len + 1);
-	if (!isdigit((int)chars[0])) {
-		free(buffer);
+	if (len == 0 || !isdigit((int)chars[0])) {
 		return NAN;
 	}
-	size_t curr = 0;
-	for (size_t i = 0; i < len; ++i) {
-		if (chars[i] == '_' && chars[i-1] != '.') {
-			continue;
-		}
-		buffer[curr++] = chars[i];
-	}
-	buffer[curr] = '\0';
-	bool ok = true;
-	yasl_float result = parsedouble(buffer, &ok);
-	if (ok) {
-		free(buffer);
+
+	yasl_float result;
+	if (float64_parse(chars, len, &result)) {
 		return result;
 	}
 
-	result = (yasl_float)parseint64(buffer, &ok);
-	if (ok) {
-		free(buffer);
-		return result;
+	yasl_int tmp;
+	if (parseint64(chars, len, &tmp)) {
+		return (yasl_float)tmp;
 	}
 
-	free(buffer);
 	return NAN;
 }
 
 yasl_int YASL_String_toint(const char *chars, const size_t len) {
-	char *buffer = (char *)malloc(len + 1);
-
-	if (len <= 2) {
-		memcpy(buffer, chars, len);
-		buffer[len] = '\0';
-		bool ok;
-		yasl_int tmp = parseint64(buffer, &ok);
-		YASL_ASSERT(ok, "parsing int from small buffer should never fail.");
-		free(buffer);
-		return tmp;
-	}
-
-	if (chars[0] == '0' && (isalpha((int)chars[1]))) {
-		size_t curr = 2;
-		buffer[0] = chars[0];
-		buffer[1] = chars[1];
-		for (size_t i = 2; i < len; ++i) {
-			if (chars[i] == '_') {
-				continue;
-			}
-			buffer[curr++] = chars[i];
-		}
-		buffer[curr] = '\0';
-		bool ok;
-		yasl_int tmp = parseint64(buffer, &ok);
-		YASL_ASSERT(ok, "parsing int from validated buffer should never fail.");
-		free(buffer);
-		return tmp;
-	}
-
-	size_t curr = 0;
-	for (size_t i = 0; i < len; ++i) {
-		if (chars[i] == '_') {
-			continue;
-		}
-		buffer[curr++] = chars[i];
+	size_t i = 0;
+	while (i < len && isspace((int)chars[i])) {
+		i++;
 	}
-	buffer[curr] = '\0';
 
-	bool ok;
-	yasl_int tmp = parseint64(buffer, &ok);
-	YASL_ASSERT(ok, "parsing int from validated buffer should never fail.");
-	free(buffer);
-	return tmp;
+	yasl_int result;
+	return parseint64(chars + i, len - i, &result) ? result : 0;
 }
 
-#define UPPER(c) (0x61 <= (c) && (c) < 0x7B ? (c) & ~0x20 : (c))
-#define LOWER(c) (0x41 <= curr && curr < 0x5B ? (c) | 0x20 : (c))
-
-// TODO: this is very ASCII reliant. Clean these up.
-#define DEFINE_STR_TO_X(name, fun) struct YASL_String *YASL_String_to##name(struct VM *vm, struct YASL_String *a) {\
+#define DEFINE_STR_TO_X(name) struct YASL_String *YASL_String_to##name(struct VM *vm, struct YASL_String *a) {\
 	const size_t length = YASL_String_len(a);\
-	const char *chars = YASL_String_chars(a);\
-	size_t i = 0;\
-	char curr;\
 	char *ptr = (char *)malloc(length);\
-\
-	while (i < length) {\
-		curr = chars[i];\
-		ptr[i++] = fun(curr);\
-	}\
-\
+	ascii_to##name(ptr, YASL_String_chars(a), length);\
 	return YASL_String_new_take(vm, ptr, length);\
 }
 
-DEFINE_STR_TO_X(upper, UPPER);
-DEFINE_STR_TO_X(lower, LOWER);
+DEFINE_STR_TO_X(upper)
+DEFINE_STR_TO_X(lower)
 
 bool YASL_String_startswith(struct YASL_String *haystack, struct YASL_String *needle) {
 	const size_t needle_len = YASL_String_len(needle);
@@ -319,24 +319,24 @@ bool YASL_String_endswith(struct YASL_String *haystack, struct YASL_String *need
 
 #define STR_REPLACE(cond, post) \
 	YASL_ASSERT(YASL_String_len(search_str) >= 1, "`search_str` must be non-empty");\
-	unsigned char *str_ptr = (unsigned char *) CHARS(str);\
+	const char *str_ptr = CHARS(str);\
 	const size_t str_len = YASL_String_len(str);\
-	const char *search_str_ptr = CHARS(search_str);\
 	const size_t search_len = YASL_String_len(search_str);\
-	unsigned char *replace_str_ptr = (unsigned char *) CHARS(replace_str);\
+	struct StrSearcher searcher;\
+	str_searcher_init(&searcher, CHARS(search_str), search_len);\
 	\
 	YASL_ByteBuffer buff = NEW_BB(str_len);\
 	size_t i = 0;\
-	while (i < str_len) {\
-		if (search_len <= str_len - i && memcmp(str_ptr + i, search_str_ptr, search_len) == 0 && (cond)) {\
-			YASL_ByteBuffer_extend(&buff, replace_str_ptr, YASL_String_len(replace_str));\
-			i += search_len;\
-			++*replacements;\
-			post;\
-		} else {\
-			YASL_ByteBuffer_add_byte(&buff, str_ptr[i++]);\
-		}\
+	const char *found;\
+	while ((cond) && (found = str_searcher_find(&searcher, str_ptr + i, str_len - i))) {\
+		const size_t index = found - str_ptr;\
+		YASL_ByteBuffer_extend(&buff, (const byte *)str_ptr + i, index - i);\
+		YASL_ByteBuffer_extend(&buff, (const byte *)CHARS(replace_str), YASL_String_len(replace_str));\
+		i = index + search_len;\
+		++*replacements;\
+		post;\
 	}\
+	YASL_ByteBuffer_extend(&buff, (const byte *)str_ptr + i, str_len - i);\
 	return YASL_String_new_takebb(vm, &buff);
 
 // Caller makes sure search_str is at least length 1.
@@ -355,12 +355,14 @@ yasl_int YASL_String_count(struct YASL_String *haystack, struct YASL_String *nee
 	const size_t nLen = YASL_String_len(needle);
 	const size_t hLen = YASL_String_len(haystack);
 	const char *haystack_chars = YASL_String_chars(haystack);
+	struct StrSearcher searcher;
+	str_searcher_init(&searcher, CHARS(needle), nLen);
 	int64_t count = 0;
-	for(int64_t i = 0; i + nLen <= hLen; i++) {
-		if(!memcmp(CHARS(needle), haystack_chars + i, nLen)) {
-			count++;
-			i += nLen-1;
-		}
+	size_t i = 0;
+	const char *found;
+	while ((found = str_searcher_find(&searcher, haystack_chars + i, hLen - i))) {
+		count++;
+		i = found - haystack_chars + nLen;
 	}
 
 	return count;
@@ -371,14 +373,10 @@ yasl_int YASL_String_count(struct YASL_String *haystack, struct YASL_String *nee
 	const char *haystack_chars = YASL_String_chars(haystack);\
 	size_t end = 0, start = 0;\
 	while (COND) {\
-		while (end < haystack_len && iswhitespace(haystack_chars[end])) {\
-			end++;\
-		}\
+		end += ascii_span_space(haystack_chars + end, haystack_len - end);\
 		if (end >= haystack_len) break;\
 		start = end;\
-		while (end < haystack_len && !iswhitespace(haystack_chars[end])) {\
-			end++;\
-		}\
+		end += ascii_cspan_space(haystack_chars + end, haystack_len - end);\
 		struct YASL_Object to = YASL_STR(\
 			YASL_String_new_substring(vm, haystack, start, end));\
 		YASL_List_push(data, to);\
@@ -392,11 +390,8 @@ void YASL_String_split_default(struct VM *vm, struct YASL_List *data, struct YAS
 void YASL_String_split_default_max(struct VM *vm, struct YASL_List *data, struct YASL_String *haystack, yasl_int max_splits) {
 	YASL_ASSERT(max_splits >= 0, "max_splits should be greater than or equal to 0");
 	DEF_STR_SPLIT_DEFAULT(max_splits > 0, max_splits--);
-	start = end;
+	start = end + ascii_span_space(haystack_chars + end, haystack_len - end);
 	end = haystack_len;
-	while (start < haystack_len && iswhitespace(haystack_chars[start])) {
-		start++;
-	}
 	if (start >= end) return;
 	struct YASL_Object to = YASL_STR(\
 			YASL_String_new_substring(vm, haystack, start, end));
@@ -406,24 +401,22 @@ void YASL_String_split_default_max(struct VM *vm, struct YASL_List *data, struct
 #define DEF_STR_SPLIT(COND, POST) \
 	YASL_ASSERT(YASL_String_len(needle) != 0, "needle must have non-zero length");\
 	const size_t needle_len = YASL_String_len(needle);\
+	const size_t haystack_len = YASL_String_len(haystack);\
 	const char *haystack_chars = YASL_String_chars(haystack);\
-	const char *needle_chars = YASL_String_chars(needle);\
-	int64_t end = 0, start = 0;\
-	while (end + needle_len <= YASL_String_len(haystack) && (COND)) {\
-		if (!memcmp(haystack_chars + end, needle_chars, needle_len)) {\
-			struct YASL_Object to = YASL_STR(\
-				YASL_String_new_substring(vm, haystack, start, end));\
-			YASL_List_push(data, to);\
-			end += needle_len;\
-			start = end;\
-			POST;\
-		} else {\
-			end++;\
-		}\
+	struct StrSearcher searcher;\
+	str_searcher_init(&searcher, YASL_String_chars(needle), needle_len);\
+	size_t start = 0;\
+	const char *found;\
+	while ((COND) && (found = str_searcher_find(&searcher, haystack_chars + start, haystack_len - start))) {\
+		const size_t end = found - haystack_chars;\
+		struct YASL_Object to = YASL_STR(\
+			YASL_String_new_substring(vm, haystack, start, end));\
+		YASL_List_push(data, to);\
+		start = end + needle_len;\
+		POST;\
 	}\
-	end = YASL_String_len(haystack);\
 	struct YASL_Object to = YASL_STR(\
-		YASL_String_new_substring(vm, haystack, start, end));\
+		YASL_String_new_substring(vm, haystack, start, haystack_len));\
 	YASL_List_push(data, to);
 
 
@@ -442,10 +435,7 @@ void YASL_String_split_max_fast(struct VM *vm, struct YASL_List *data, struct YA
 struct YASL_String *YASL_String_ltrim_default(struct VM *vm, struct YASL_String *haystack) {
 	const size_t haystack_len = YASL_String_len(haystack);
 	const char *haystack_chars = YASL_String_chars(haystack);
-	size_t start = 0;
-	while (haystack_len - start >= 1 && iswhitespace(haystack_chars[start])) {
-		start++;
-	}
+	const size_t start = ascii_span_space(haystack_chars, haystack_len);
 
 	return YASL_String_new_substring(vm, haystack, start, haystack_len);
 }
@@ -465,11 +455,9 @@ struct YASL_String *YASL_String_ltrim(struct VM *vm, struct YASL_String *haystac
 }
 
 struct YASL_String *YASL_String_rtrim_default(struct VM *vm, struct YASL_String *haystack) {
+	const size_t haystack_len = YASL_String_len(haystack);
 	const char *haystack_chars = YASL_String_chars(haystack);
-	size_t end = YASL_String_len(haystack);
-	while (end >= 1 && iswhitespace(haystack_chars[end - 1])) {
-		end--;
-	}
+	const size_t end = haystack_len - ascii_rspan_space(haystack_chars, haystack_len);
 
 	return YASL_String_new_substring(vm, haystack, 0, end);
 }
@@ -490,15 +478,8 @@ struct YASL_String *YASL_String_rtrim(struct VM *vm, struct YASL_String *haystac
 struct YASL_String *YASL_String_trim_default(struct VM *vm, struct YASL_String *haystack) {
 	const size_t haystack_len = YASL_String_len(haystack);
 	const char *haystack_chars = YASL_String_chars(haystack);
-	size_t start = 0;
-	while (haystack_len - start >= 1 && iswhitespace(haystack_chars[start])) {
-		start++;
-	}
-
-	size_t end = haystack_len;
-	while (end >= 1 && iswhitespace(haystack_chars[end - 1])) {
-		end--;
-	}
+	const size_t start = ascii_span_space(haystack_chars, haystack_len);
+	const size_t end = haystack_len - ascii_rspan_space(haystack_chars + start, haystack_len - start);
 
 	return YASL_String_new_substring(vm, haystack, start, end);
 }
@@ -536,3 +517,69 @@ struct YASL_String *YASL_String_rep_fast(struct VM *vm, struct YASL_String *stri
 	return YASL_String_new_take(vm, str, size);
 }
 
+/*
+ * Sparse map from code points to byte offsets. Only every UTF8_INDEX_STRIDE'th code point is recorded, so finding any
+ * other one means decoding at most UTF8_INDEX_STRIDE - 1 code points from the nearest entry.
+ */
+#define UTF8_INDEX_STRIDE 32
+
+struct YASL_UTF8Index {
+	size_t count;        // number of code points
+	size_t offsets[];    // empty if every code point is a single byte
+};
+
+static struct YASL_UTF8Index invalid_utf8;
+
+static void str_utf8_index_del(struct YASL_UTF8Index *index) {
+	if (index != &invalid_utf8) {
+		free(index);
+	}
+}
+
+static struct YASL_UTF8Index *str_utf8_index(struct YASL_String *str) {
+	if (str->utf8) {
+		return str->utf8;
+	}
+
+	const char *chars = CHARS(str);
+	const size_t len = LEN(str);
+	const size_t count = utf8_count(chars, len);
+	if (count == UTF8_INVALID) {
+		return str->utf8 = &invalid_utf8;
+	}
+
+	const size_t num_offsets = count == len ? 0 : (count + UTF8_INDEX_STRIDE - 1) / UTF8_INDEX_STRIDE;
+	struct YASL_UTF8Index *index = (struct YASL_UTF8Index *)malloc(sizeof(struct YASL_UTF8Index) + num_offsets * sizeof(size_t));
+	index->count = count;
+	size_t offset = 0;
+	for (size_t i = 0; i < num_offsets; i++) {
+		index->offsets[i] = offset;
+		for (size_t j = 0; j < UTF8_INDEX_STRIDE && offset < len; j++) {
+			offset += utf8_seq_len((unsigned char)chars[offset]);
+		}
+	}
+	return str->utf8 = index;
+}
+
+size_t YASL_String_utf8_len(struct YASL_String *str) {
+	struct YASL_UTF8Index *index = str_utf8_index(str);
+	return index == &invalid_utf8 ? UTF8_INVALID : index->count;
+}
+
+size_t YASL_String_utf8_offset(struct YASL_String *str, size_t index) {
+	struct YASL_UTF8Index *utf8 = str_utf8_index(str);
+	YASL_ASSERT(utf8 != &invalid_utf8 && index <= utf8->count, "index must be in range of a valid UTF-8 str");
+	if (utf8->count == LEN(str)) {
+		return index;
+	}
+	if (index == utf8->count) {
+		return LEN(str);
+	}
+
+	const char *chars = CHARS(str);
+	size_t offset = utf8->offsets[index / UTF8_INDEX_STRIDE];
+	for (size_t i = index % UTF8_INDEX_STRIDE; i > 0; i--) {
+		offset += utf8_seq_len((unsigned char)chars[offset]);
+	}
+	return offset;
+}
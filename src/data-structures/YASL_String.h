@@ -14,12 +14,19 @@ struct VM;
 /*
  * Reference-counted string type. Used in the YASL interpreter.
  */
+// Strings up to this length are interned when created at runtime. Constants are always interned.
+#define YASL_STRING_INTERN_MAX_LEN 32
+
+struct YASL_UTF8Index;
+
 struct YASL_String {
 	struct RC rc;      // NOTE: RC MUST BE THE FIRST MEMBER OF THIS STRUCT. DO NOT REARRANGE.
 	struct LString s;
+	struct YASL_UTF8Index *utf8;  // code point index, built on first use by the utf8 functions below
 };
 
 size_t YASL_String_len(const struct YASL_String *const str);
+// The chars are not NUL-terminated: they may point into a buffer taken as is, or into a mapped bytecode file.
 const char *YASL_String_chars(const struct YASL_String *const str);
 
 struct YASL_String *YASL_String_new_copy_unbound(const char *const ptr, const size_t size);
@@ -37,6 +44,26 @@ void str_del_data(struct YASL_String *const str);
 void str_del_rc(struct YASL_String *const str);
 void str_del(struct YASL_String *const str);
 
+/*
+ * Precomputed state for finding a needle in haystacks, using the Two-Way algorithm with a Boyer-Moore style skip on
+ * the last byte. Searching takes linear time in the worst case, and usually skips most of the haystack. Single byte
+ * needles are found with memchr.
+ */
+struct StrSearcher {
+	const unsigned char *needle;
+	size_t len;
+	size_t ms;
+	size_t period;
+	size_t memory;
+	size_t byteset[32 / sizeof(size_t)];
+	size_t shift[256];
+};
+
+// The needle must outlive the searcher.
+void str_searcher_init(struct StrSearcher *searcher, const char *needle, const size_t len);
+// Returns a pointer to the first occurrence of the needle in haystack, or NULL if there is none.
+const char *str_searcher_find(const struct StrSearcher *searcher, const char *haystack, const size_t len);
+
 int64_t str_find_index(const struct YASL_String *const haystack, const struct YASL_String *const needle, yasl_int start);
 int64_t YASL_String_cmp(const struct YASL_String *const left, const struct YASL_String *const right);
 yasl_float YASL_String_tofloat(const char *chars, const size_t len);
@@ -67,4 +94,9 @@ struct YASL_String *YASL_String_trim(struct VM *vm, struct YASL_String *haystack
 // Caller ensures num is greater than or equal to zero
 struct YASL_String *YASL_String_rep_fast(struct VM *vm, struct YASL_String *string, yasl_int num);
 
+// Returns the number of code points in str, or UTF8_INVALID if str is not valid UTF-8.
+size_t YASL_String_utf8_len(struct YASL_String *str);
+// Returns the byte offset of code point index. Caller makes sure str is valid UTF-8 and index <= its utf8 length.
+size_t YASL_String_utf8_offset(struct YASL_String *str, size_t index);
+
 #endif
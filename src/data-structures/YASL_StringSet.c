@@ -1,24 +1,172 @@
-#include <interpreter/YASL_Object.h>
 #include "YASL_StringSet.h"
 
+#include <stdint.h>
+#include <string.h>
+
+#define STRINGSET_BASESIZE 64
+
+struct InternedString {
+	struct YASL_String string;  // NOTE: MUST BE THE FIRST MEMBER OF THIS STRUCT.
+	struct YASL_StringSet *set;
+	size_t hash;
+};
+
+static struct InternedString removed;
+#define REMOVED (&removed)
+
+static size_t stringset_hash(const char *chars, const size_t len) {
+	// FNV-1a
+	size_t hash = (size_t)UINT64_C(14695981039346656037);
+	for (size_t i = 0; i < len; i++) {
+		hash ^= (unsigned char)chars[i];
+		hash *= (size_t)UINT64_C(1099511628211);
+	}
+	return hash;
+}
+
+static struct InternedString **stringset_items_new(const size_t size) {
+	return (struct InternedString **)calloc(size, sizeof(struct InternedString *));
+}
+
 struct YASL_StringSet *YASL_StringSet_new(void) {
-	return (struct YASL_StringSet *)YASL_Set_new();
+	return YASL_StringSet_new_sized(STRINGSET_BASESIZE);
+}
+
+struct YASL_StringSet *YASL_StringSet_new_sized(const size_t size) {
+	struct YASL_StringSet *set = (struct YASL_StringSet *)malloc(sizeof(struct YASL_StringSet));
+	set->size = size < STRINGSET_BASESIZE ? STRINGSET_BASESIZE : size;
+	set->count = 0;
+	set->used = 0;
+	set->items = stringset_items_new(set->size);
+	return set;
 }
 
 void YASL_StringSet_del(struct YASL_StringSet *set) {
-	YASL_Set_del(NULL, set);
+	for (size_t i = 0; i < set->size; i++) {
+		struct InternedString *item = set->items[i];
+		if (!item || item == REMOVED) continue;
+		if (item->string.rc.refs == 0) {
+			// never referenced by anything, so only the set knows about it.
+			str_del_data(&item->string);
+			free(item);
+		} else {
+			// still referenced elsewhere; it will be freed as a normal string.
+			item->string.rc.is_interned = false;
+		}
+	}
+	free(set->items);
+	free(set);
+}
+
+static void stringset_resize(struct YASL_StringSet *const set, const size_t size) {
+	struct InternedString **old_items = set->items;
+	const size_t old_size = set->size;
+	set->items = stringset_items_new(size);
+	set->size = size;
+	set->used = set->count;
+	for (size_t i = 0; i < old_size; i++) {
+		struct InternedString *item = old_items[i];
+		if (!item || item == REMOVED) continue;
+		size_t index = item->hash & (size - 1);
+		while (set->items[index]) {
+			index = (index + 1) & (size - 1);
+		}
+		set->items[index] = item;
+	}
+	free(old_items);
+}
+
+enum InternMode {
+	INTERN_COPY,
+	INTERN_TAKE,
+	INTERN_BORROW
+};
+
+static struct YASL_String *stringset_intern_hashed(struct YASL_StringSet *const set, const char *chars,
+						   const size_t len, const size_t hash, const enum InternMode mode) {
+	const size_t mask = set->size - 1;
+	size_t index = hash & mask;
+	size_t insert_at = set->size;
+	struct InternedString *item;
+	while ((item = set->items[index])) {
+		if (item == REMOVED) {
+			if (insert_at == set->size) insert_at = index;
+		} else if (item->hash == hash && YASL_String_len(&item->string) == len &&
+			   (len == 0 || !memcmp(YASL_String_chars(&item->string), chars, len))) {
+			if (mode == INTERN_TAKE) free((char *)chars);
+			return &item->string;
+		}
+		index = (index + 1) & mask;
+	}
+
+	if (insert_at == set->size) {
+		insert_at = index;
+		set->used++;
+	}
+
+	char *mem = (char *)chars;
+	if (mode == INTERN_COPY) {
+		// Copies live in the same allocation as the string, right after it, so they are freed along with it.
+		item = (struct InternedString *)malloc(sizeof(struct InternedString) + len + 1);
+		mem = (char *)(item + 1);
+		if (len) memcpy(mem, chars, len);
+		mem[len] = '\0';
+	} else {
+		item = (struct InternedString *)malloc(sizeof(struct InternedString));
+	}
+
+	LString_init(&item->string.s, mem, len);
+	item->string.rc = NEW_RC();
+	item->string.rc.is_interned = true;
+	item->string.rc.is_borrowed = mode != INTERN_TAKE;
+	item->string.utf8 = NULL;
+	item->set = set;
+	item->hash = hash;
+	set->items[insert_at] = item;
+	set->count++;
+
+	if (set->used * 4 > set->size * 3) {
+		stringset_resize(set, set->count * 2 > set->size ? set->size * 2 : set->size);
+	}
+
+	return &item->string;
 }
 
-struct YASL_Object *YASL_Set_search_internal(const struct YASL_Set *const set, const struct YASL_Object key);
+static struct YASL_String *stringset_intern(struct YASL_StringSet *const set, const char *chars, const size_t len,
+					    const enum InternMode mode) {
+	return stringset_intern_hashed(set, chars, len, stringset_hash(chars, len), mode);
+}
 
-struct YASL_String *YASL_StringSet_maybe_insert(struct YASL_StringSet *const set, const char *chars, const size_t size) {
-	struct YASL_String *string = YASL_String_new_copy_unbound(chars, size);
-	const struct YASL_Object *result = YASL_Set_search_internal(&set->impl, YASL_STR(string));
-	if (!result) {
-		YASL_Set_insert(&set->impl, YASL_STR(string));
-		return string;
+struct YASL_String *YASL_StringSet_maybe_insert(struct YASL_StringSet *const set, const char *chars, const size_t len) {
+	return stringset_intern(set, chars, len, INTERN_COPY);
+}
+
+struct YASL_String *YASL_StringSet_maybe_insert_take(struct YASL_StringSet *const set, const char *mem, const size_t len) {
+	return stringset_intern(set, mem, len, INTERN_TAKE);
+}
+
+struct YASL_String *YASL_StringSet_maybe_insert_borrow(struct YASL_StringSet *const set, const char *chars, const size_t len) {
+	return stringset_intern(set, chars, len, INTERN_BORROW);
+}
+
+struct YASL_String *YASL_StringSet_copy(struct YASL_StringSet *const set, const struct YASL_String *string) {
+	const struct InternedString *item = (const struct InternedString *)string;
+	return stringset_intern_hashed(set, YASL_String_chars(string), YASL_String_len(string), item->hash, INTERN_COPY);
+}
+
+void YASL_StringSet_rm(struct YASL_String *string) {
+	struct InternedString *item = (struct InternedString *)string;
+	struct YASL_StringSet *set = item->set;
+	const size_t mask = set->size - 1;
+	size_t index = item->hash & mask;
+	while (set->items[index] != item) {
+		index = (index + 1) & mask;
 	}
+	set->items[index] = REMOVED;
+	set->count--;
+	string->rc.is_interned = false;
 
-	str_del(string);
-	return result->value.sval;
-}
\ No newline at end of file
+	if (set->size > STRINGSET_BASESIZE && set->count * 8 < set->size) {
+		stringset_resize(set, set->size / 2);
+	}
+}
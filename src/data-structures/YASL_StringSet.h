@@ -1,11 +1,50 @@
-#include "YASL_Set.h"
+#ifndef YASL_YASL_STRINGSET_H_
+#define YASL_YASL_STRINGSET_H_
+
 #include "YASL_String.h"
 
+/*
+ * Weak set of interned strings. The set holds no references: an interned string removes itself from the set when its
+ * last reference is dropped, so the set only ever contains live strings.
+ */
 struct YASL_StringSet {
-	struct YASL_Set impl;
+	size_t size;   // number of slots, always a power of 2
+	size_t count;  // number of live strings
+	size_t used;   // number of live strings plus removed slots
+	struct InternedString **items;
 };
 
 struct YASL_StringSet *YASL_StringSet_new(void);
+// size must be a power of 2.
+struct YASL_StringSet *YASL_StringSet_new_sized(const size_t size);
 void YASL_StringSet_del(struct YASL_StringSet *set);
 
+/*
+ * Looks up the string with the given chars, hashing them before anything is allocated. On a miss, a copy is made and
+ * interned.
+ */
 struct YASL_String *YASL_StringSet_maybe_insert(struct YASL_StringSet *const set, const char *chars, const size_t len);
+
+/*
+ * Like YASL_StringSet_maybe_insert, but takes ownership of mem, which is freed on a hit.
+ */
+struct YASL_String *YASL_StringSet_maybe_insert_take(struct YASL_StringSet *const set, const char *mem, const size_t len);
+
+/*
+ * Like YASL_StringSet_maybe_insert, but on a miss the new string points at chars instead of a copy, so chars must
+ * outlive it. chars need not be nul-terminated.
+ */
+struct YASL_String *YASL_StringSet_maybe_insert_borrow(struct YASL_StringSet *const set, const char *chars, const size_t len);
+
+/*
+ * Like YASL_StringSet_maybe_insert, with the chars of string, which must be interned in some other set. Reuses the hash
+ * computed by that set rather than hashing the chars again.
+ */
+struct YASL_String *YASL_StringSet_copy(struct YASL_StringSet *const set, const struct YASL_String *string);
+
+/*
+ * Removes an interned string from the set it was interned in. Called when the string is about to be freed.
+ */
+void YASL_StringSet_rm(struct YASL_String *string);
+
+#endif
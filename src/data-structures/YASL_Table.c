@@ -148,10 +148,12 @@ void YASL_Table_insert_zstring_int(struct YASL_Table *const table, const char *c
 
 void YASL_Table_insert_string_int(struct YASL_Table *const table, const char *const key, const size_t key_len,
 				  const int64_t val) {
-	struct YASL_String *string = YASL_String_new_copy_unbound(key, key_len);
-	struct YASL_Object ko = YASL_STR(string);
 	struct YASL_Object vo = YASL_INT(val);
-	YASL_Table_insert_fast(table, ko, vo);
+	if (YASL_Table_replace_string(table, key, key_len, vo)) {
+		return;
+	}
+	struct YASL_String *string = YASL_String_new_copy_unbound(key, key_len);
+	YASL_Table_insert_fast(table, YASL_STR(string), vo);
 }
 
 yasl_int YASL_Table_length(const struct YASL_Table *const ht) {
@@ -174,22 +176,61 @@ struct YASL_Object YASL_Table_search(const struct YASL_Table *const table, const
 	return YASL_END();
 }
 
+/*
+ * Finds the item whose key is a string with the given contents. Probes in the same order as YASL_Table_getindex, but
+ * compares the bytes in place, so no string object is needed for the key.
+ */
+static struct YASL_Table_Item *table_find_string(const struct YASL_Table *const table, const char *const key,
+						  const size_t key_len) {
+	size_t index = get_hash_chars(key, key_len, table->size, 0);
+	struct YASL_Table_Item *item = &table->items[index];
+	size_t i = 1;
+	while (!obj_isundef(&item->key)) {
+		if (obj_isstr(&item->key) && YASL_String_len(item->key.value.sval) == key_len &&
+		    !memcmp(YASL_String_chars(item->key.value.sval), key, key_len)) {
+			return item;
+		}
+		index = get_hash_chars(key, key_len, table->size, i++);
+		item = &table->items[index];
+	}
+	return NULL;
+}
+
+bool YASL_Table_replace_string(struct YASL_Table *const table, const char *const key, const size_t key_len,
+			       const struct YASL_Object value) {
+	struct YASL_Table_Item *item = table_find_string(table, key, key_len);
+	if (!item) {
+		return false;
+	}
+	struct YASL_Object old_value = item->value;
+	item->value = value;
+	inc_ref(&item->value);
+	dec_ref(&old_value);
+	return true;
+}
+
+struct YASL_Object YASL_Table_search_string(const struct YASL_Table *const table, const char *const key,
+					    const size_t key_len) {
+	YASL_ASSERT(table != NULL, "table to search should not be NULL");
+	const struct YASL_Table_Item *item = table_find_string(table, key, key_len);
+	return item ? item->value : YASL_END();
+}
+
+struct YASL_Object YASL_Table_search_zstring(const struct YASL_Table *const table, const char *const key) {
+	return YASL_Table_search_string(table, key, strlen(key));
+}
+
 bool YASL_Table_contains_zstring_int(const struct YASL_Table *const table, const char *const key) {
 	return YASL_Table_search_zstring_int(table, key).type == Y_INT;
 }
 
 struct YASL_Object YASL_Table_search_zstring_int(const struct YASL_Table *const table, const char *const key) {
-	return YASL_Table_search_string_int(table, key, strlen(key));
+	return YASL_Table_search_string(table, key, strlen(key));
 }
 
 struct YASL_Object YASL_Table_search_string_int(const struct YASL_Table *const table, const char *const key,
 						const size_t key_len) {
-	struct YASL_String *string = YASL_String_new_copy_unbound(key, key_len);
-	struct YASL_Object object = YASL_STR(string);
-
-	struct YASL_Object result = YASL_Table_search(table, object);
-	str_del(string);
-	return result;
+	return YASL_Table_search_string(table, key, key_len);
 }
 
 void YASL_Table_rm(struct YASL_Table *const table, const struct YASL_Object key) {
@@ -56,9 +56,17 @@ void YASL_Table_insert_string_int(struct YASL_Table *const table, const char *co
 				  const int64_t val);
 bool YASL_Table_contains_zstring_int(const struct YASL_Table *const table, const char *const key);
 void YASL_Table_insert_zstring_int(struct YASL_Table *const table, const char *const key, const int64_t val);
+// If `table` has a string key with the given contents, sets its value to `value` and returns true. Otherwise, returns
+// false and leaves `table` unchanged. Never allocates.
+bool YASL_Table_replace_string(struct YASL_Table *const table, const char *const key, const size_t key_len,
+			       const struct YASL_Object value);
 
 yasl_int YASL_Table_length(const struct YASL_Table *const ht);
 struct YASL_Object YASL_Table_search(const struct YASL_Table *const table, const struct YASL_Object key);
+// Same as YASL_Table_search with a string key with the given contents, but without allocating the key.
+struct YASL_Object YASL_Table_search_string(const struct YASL_Table *const table, const char *const key,
+					    const size_t key_len);
+struct YASL_Object YASL_Table_search_zstring(const struct YASL_Table *const table, const char *const key);
 struct YASL_Object YASL_Table_search_string_int(const struct YASL_Table *const table, const char *const key,
 						const size_t key_len);
 struct YASL_Object YASL_Table_search_zstring_int(const struct YASL_Table *const table, const char *const key);
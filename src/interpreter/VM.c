@@ -16,6 +16,7 @@
 #include "interpreter/methods/table_methods.h"
 #include "interpreter/methods/list_methods.h"
 #include "interpreter/methods/str_methods.h"
+#include "interpreter/methods/str_iter_methods.h"
 #include "yasl_state.h"
 #include "yasl_error.h"
 #include "yasl_include.h"
@@ -43,11 +44,12 @@ static struct RC_UserData **builtins_htable_new(struct VM *const vm) {
 	return ht;
 }
 
-void vm_init(struct VM *const vm,
-	     unsigned char *const code,    // pointer to bytecode
-             const size_t pc,              // address of instruction to be executed first (entrypoint)
-             const size_t datasize) {      // total params size required to perform a program operations
+/*
+ * Sets up everything but the tables and interned strings of vm, which are left for the caller to create.
+ */
+static void vm_init_empty(struct VM *const vm, unsigned char *const code, const size_t pc, const size_t datasize) {
 	vm->code = code;
+	vm->code_is_image = false;
 	vm->headers = (unsigned char **)calloc(sizeof(unsigned char *), datasize);
 	vm->headers_size = datasize;
 	vm->frame_num = -1;
@@ -57,20 +59,187 @@ void vm_init(struct VM *const vm,
 	for (size_t i = 0; i < datasize; i++) {
 		vm->headers[i] = NULL;
 	}
-	vm->metatables = YASL_Table_new();
 	vm->headers[datasize - 1] = code;
-	vm->globals = YASL_Table_new();
 	vm->pc = code + pc;
 	vm->fp = -1;
 	vm->sp = -1;
 	vm->num_constants = 0;
 	vm->constants = NULL;
 	vm->stack = (struct YASL_Object *)calloc(sizeof(struct YASL_Object), STACK_SIZE);
-	vm->interned_strings = YASL_StringSet_new();
-	vm->builtins_htable = builtins_htable_new(vm);
 	vm->pending = NULL;
 	vm->buf = NULL;
 	vm->format_str = NULL;
+	vm->num_threads = 1;
+	memset(vm->char_strs, 0, sizeof(vm->char_strs));
+	memset(vm->int_strs, 0, sizeof(vm->int_strs));
+}
+
+void vm_init(struct VM *const vm,
+	     unsigned char *const code,    // pointer to bytecode
+             const size_t pc,              // address of instruction to be executed first (entrypoint)
+             const size_t datasize) {      // total params size required to perform a program operations
+	vm_init_empty(vm, code, pc, datasize);
+	vm->interned_strings = YASL_StringSet_new();
+	vm->metatables = YASL_Table_new();
+	vm->globals = YASL_Table_new();
+	vm->modules = YASL_Table_new();
+	vm->evals = YASL_Table_new();
+	vm->builtins_htable = builtins_htable_new(vm);
+	YASL_Table_insert_fast(vm->metatables, YASL_STR(YASL_String_new_copyz(vm, STR_ITER_NAME)),
+			       YASL_TABLE(ud_new(str_iter_builtins(vm), TABLE_NAME, NULL, rcht_del_data)));
+}
+
+/*
+ * State for copying values from one VM into another. Objects that can be reached more than once are recorded in
+ * copies, keyed by their address in the source VM, so that they are copied only once.
+ */
+struct VM_Copier {
+	struct VM *vm;
+	struct YASL_Table *copies;
+	bool ok;  // false once a value that can't be copied has been seen
+};
+
+static struct YASL_Object vm_copy_object(struct VM_Copier *copier, const struct YASL_Object src);
+
+static void *vm_copy_find(struct VM_Copier *copier, const struct RC *rc) {
+	// An object with a single reference can only be reached once, so it is never recorded.
+	if (rc->refs <= 1) return NULL;
+	struct YASL_Object copy = YASL_Table_search(copier->copies, YASL_USERPTR((void *)rc));
+	return copy.type == Y_END ? NULL : copy.value.pval;
+}
+
+static void vm_copy_record(struct VM_Copier *copier, const struct RC *rc, void *copy) {
+	if (rc->refs <= 1) return;
+	YASL_Table_insert_fast(copier->copies, YASL_USERPTR((void *)rc), YASL_USERPTR(copy));
+}
+
+static struct YASL_String *vm_copy_str(struct VM_Copier *copier, const struct YASL_String *src) {
+	if (src->rc.is_interned) {
+		return YASL_StringSet_copy(copier->vm->interned_strings, src);
+	}
+	return YASL_String_new_copy_unbound(YASL_String_chars(src), YASL_String_len(src));
+}
+
+static struct YASL_Table *vm_copy_table(struct VM_Copier *copier, const struct YASL_Table *src) {
+	struct YASL_Table *table = (struct YASL_Table *)malloc(sizeof(struct YASL_Table));
+	table->size = src->size;
+	table->base_size = src->base_size;
+	table->count = src->count;
+	table->default_val = vm_copy_object(copier, src->default_val);
+	inc_ref(&table->default_val);
+	table->items = (struct YASL_Table_Item *)calloc(src->size, sizeof(struct YASL_Table_Item));
+
+	// Keys hash the same in every VM, so each item can stay in the same slot.
+	for (size_t i = 0; i < src->size; i++) {
+		const struct YASL_Table_Item *item = &src->items[i];
+		if (item->key.type == Y_END) {
+			table->items[i] = TOMBSTONE;
+			continue;
+		}
+		if (obj_isundef(&item->value)) continue;
+
+		struct YASL_Table_Item *copy = &table->items[i];
+		copy->value = vm_copy_object(copier, item->value);
+		if (obj_isundef(&copy->value)) {
+			*copy = TOMBSTONE;
+			table->count--;
+			continue;
+		}
+		copy->key = obj_isstr(&item->key) ? YASL_STR(vm_copy_str(copier, item->key.value.sval)) : item->key;
+		inc_ref(&copy->key);
+		inc_ref(&copy->value);
+	}
+	return table;
+}
+
+static struct YASL_List *vm_copy_list(struct VM_Copier *copier, const struct YASL_List *src) {
+	struct YASL_List *ls = YASL_List_new_sized(src->size);
+	FOR_LIST(i, item, src) {
+		YASL_List_push(ls, vm_copy_object(copier, item));
+	}
+	return ls;
+}
+
+static struct RC_UserData *vm_copy_userdata(struct VM_Copier *copier, const struct RC_UserData *src,
+					    const enum YASL_Types type) {
+	struct RC_UserData *ud = (struct RC_UserData *)vm_copy_find(copier, &src->rc);
+	if (ud) return ud;
+
+	switch (type) {
+	case Y_TABLE:
+	case Y_LIST:
+		ud = ud_new(NULL, src->tag, NULL, src->destructor);
+		break;
+	default:
+		// We can only share the data of userdata that doesn't own it.
+		if (src->destructor) return NULL;
+		ud = ud_new(src->data, src->tag, NULL, NULL);
+		break;
+	}
+	vm_copy_record(copier, &src->rc, ud);
+
+	if (src->mt) {
+		ud->mt = vm_copy_userdata(copier, src->mt, Y_TABLE);
+		ud->mt->rc.refs++;
+	}
+	if (type == Y_TABLE) {
+		ud->data = vm_copy_table(copier, (const struct YASL_Table *)src->data);
+	} else if (type == Y_LIST) {
+		ud->data = vm_copy_list(copier, (const struct YASL_List *)src->data);
+	}
+	return ud;
+}
+
+static struct YASL_Object vm_copy_object(struct VM_Copier *copier, const struct YASL_Object src) {
+	struct YASL_Object copy = src;
+	switch (src.type) {
+	case Y_STR:
+		copy.value.sval = vm_copy_str(copier, src.value.sval);
+		return copy;
+	case Y_LIST:
+	case Y_TABLE:
+	case Y_USERDATA:
+		copy.value.uval = vm_copy_userdata(copier, src.value.uval, src.type);
+		if (!copy.value.uval) break;
+		return copy;
+	case Y_CFN:
+		copy.value.cval = (struct CFunction *)vm_copy_find(copier, &src.value.cval->rc);
+		if (!copy.value.cval) {
+			copy.value.cval = new_cfn(src.value.cval->value, src.value.cval->num_args);
+			vm_copy_record(copier, &src.value.cval->rc, copy.value.cval);
+		}
+		return copy;
+	case Y_FN:
+	case Y_CLOSURE:
+		// These point into the code of the source VM.
+		break;
+	default:
+		return copy;
+	}
+	copier->ok = false;
+	return YASL_UNDEF();
+}
+
+bool vm_init_copy(struct VM *const vm, const struct VM *const src) {
+	vm_init_empty(vm, NULL, 0, 1);
+	vm->out.print = src->out.print;
+	vm->err.print = src->err.print;
+	vm->num_threads = src->num_threads;
+	// Start with room for every string src has, so that copying them never resizes the set.
+	vm->interned_strings = YASL_StringSet_new_sized(src->interned_strings->size);
+
+	struct VM_Copier copier = { vm, YASL_Table_new(), true };
+	vm->builtins_htable = (struct RC_UserData **) malloc(sizeof(struct RC_UserData *) * NUM_TYPES);
+	for (int type = Y_UNDEF; type <= Y_TABLE; type++) {
+		vm->builtins_htable[type] = vm_copy_userdata(&copier, src->builtins_htable[type], Y_TABLE);
+		vm->builtins_htable[type]->rc.refs++;
+	}
+	vm->metatables = vm_copy_table(&copier, src->metatables);
+	vm->globals = vm_copy_table(&copier, src->globals);
+	vm->modules = YASL_Table_new();
+	vm->evals = YASL_Table_new();
+	YASL_Table_del(copier.copies);
+	return copier.ok;
 }
 
 void vm_close_all(struct VM *const vm);
@@ -102,8 +271,9 @@ void vm_cleanup(struct VM *const vm) {
 		free(vm->headers[i]);
 	}
 	free(vm->headers);
-	YASL_StringSet_del(vm->interned_strings);
 	YASL_Table_del(vm->globals);
+	YASL_Table_del(vm->modules);
+	YASL_Table_del(vm->evals);
 
 	YASL_Table_del(vm->metatables);
 
@@ -124,6 +294,21 @@ void vm_cleanup(struct VM *const vm) {
 	vm_dec_ref(vm, &v);
 	free(vm->builtins_htable);
 
+	for (size_t i = 0; i < sizeof(vm->char_strs) / sizeof(vm->char_strs[0]); i++) {
+		if (vm->char_strs[i]) {
+			v = YASL_STR(vm->char_strs[i]);
+			vm_dec_ref(vm, &v);
+		}
+	}
+	for (size_t i = 0; i < sizeof(vm->int_strs) / sizeof(vm->int_strs[0]); i++) {
+		if (vm->int_strs[i]) {
+			v = YASL_STR(vm->int_strs[i]);
+			vm_dec_ref(vm, &v);
+		}
+	}
+
+	YASL_StringSet_del(vm->interned_strings);
+
 	io_cleanup(&vm->out);
 	io_cleanup(&vm->err);
 }
@@ -148,29 +333,57 @@ YASL_FORMAT_CHECK static void vm_print_err_wrapper(struct VM *vm, const char *co
 static void vm_exitframe(struct VM *const vm);
 void vm_executenext(struct VM *const vm);
 
-static size_t vm_getcurrline(struct VM *vm) {
-	size_t start = ((int64_t *)vm->code)[0];
-	size_t line_start = ((int64_t *)vm->code)[1];
-	const unsigned char *tmp = vm->code + line_start;
+static size_t code_getline(const unsigned char *code, const unsigned char *pc) {
+	size_t start = ((int64_t *)code)[0];
+	size_t line_start = ((int64_t *)code)[1];
+	const unsigned char *tmp = code + line_start;
 	long unsigned i = 0;
-	while (vint_decode(tmp) < vm->pc - vm->code - start) {
+	while (vint_decode(tmp) < pc - code - start) {
 		tmp = vint_next(tmp);
 		i++;
 	}
 	return i;
 }
 
-static void printline(struct VM *vm) {
-	size_t line =  vm_getcurrline(vm);
+static bool code_contains(const unsigned char *code, const unsigned char *pc) {
+	return code + ((int64_t *)code)[0] <= pc && pc < code + ((int64_t *)code)[1];
+}
+
+static size_t vm_getcurrline(struct VM *vm) {
+	return code_getline(vm->code, vm->pc);
+}
+
+/*
+ * Finds the program containing pc, out of the main one and those loaded by require or eval. Returns NULL if pc belongs
+ * to a program this VM doesn't own.
+ */
+static const unsigned char *vm_findcode(struct VM *vm, const unsigned char *pc) {
+	if (vm->code && code_contains(vm->code, pc)) return vm->code;
+	for (size_t i = 0; i < vm->headers_size; i++) {
+		if (vm->headers[i] && code_contains(vm->headers[i], pc)) return vm->headers[i];
+	}
+	return NULL;
+}
 
-	vm_print_err_wrapper(vm, " (line %" PRI_SIZET ")\n", line);
+/*
+ * Prints the line of the current instruction and of each call leading to it, unwinding every frame above fp.
+ */
+void vm_printline(struct VM *vm, int fp) {
+	const unsigned char *code = vm_findcode(vm, vm->pc);
+	if (code) {
+		vm_print_err_wrapper(vm, " (line %" PRI_SIZET ")\n", code_getline(code, vm->pc));
+	} else {
+		vm_print_err_wrapper(vm, "\n");
+	}
 
-	if (vm->fp >= 0 && vm_peek(vm, vm->fp).type == Y_CFN) vm_exitframe(vm);
+	if (vm->fp > fp && vm_peek(vm, vm->fp).type == Y_CFN) vm_exitframe(vm);
 
-	while (vm->fp >= 0) {
+	while (vm->fp > fp) {
 		vm_exitframe(vm);
-		line = vm_getcurrline(vm);
-		vm_print_err_wrapper(vm, "In function call on line %" PRI_SIZET "\n", line);
+		code = vm_findcode(vm, vm->pc);
+		if (code) {
+			vm_print_err_wrapper(vm, "In function call on line %" PRI_SIZET "\n", code_getline(code, vm->pc));
+		}
 	}
 }
 
@@ -209,9 +422,11 @@ void vm_push(struct VM *const vm, const struct YASL_Object val) {
 
 	vm->sp++;
 
-	vm_dec_ref(vm, vm->stack + vm->sp);
+	// take the new reference first, in case the stale slot holds the last reference to the same object.
+	struct YASL_Object old = vm->stack[vm->sp];
 	vm->stack[vm->sp] = val;
 	inc_ref(vm->stack + vm->sp);
+	vm_dec_ref(vm, &old);
 }
 
 void vm_pushend(struct VM *const vm) {
@@ -238,6 +453,15 @@ void vm_pushstr_bb(struct VM *const vm, YASL_ByteBuffer *bb) {
 	vm_pushstr(vm, YASL_String_new_takebb(vm, bb));
 }
 
+struct YASL_String *vm_char_str(struct VM *const vm, const char c) {
+	struct YASL_String **slot = vm->char_strs + (unsigned char)c;
+	if (!*slot) {
+		*slot = YASL_String_new_copy(vm, &c, 1);
+		(*slot)->rc.refs++;
+	}
+	return *slot;
+}
+
 struct YASL_Object *vm_pop_p(struct VM *const vm) {
 	YASL_ASSERT(vm->sp >= 0, "cannot pop from empty stack.");
 	return vm->stack + vm->sp--;
@@ -325,6 +549,7 @@ static yasl_int vm_read_int(struct VM *const vm) {
 static void vm_duptop(struct VM *const vm);
 static void vm_swaptop(struct VM *const vm);
 int vm_lookup_method_helper(struct VM *vm, struct YASL_Table *mt, struct YASL_Object index);
+static int vm_lookup_method_name(struct VM *vm, struct YASL_Table *mt, const char *method_name);
 static void vm_GET(struct VM *const vm);
 static void vm_INIT_CALL(struct VM *const vm, int expected_returns);
 void vm_INIT_CALL_offset(struct VM *const vm, int offset, int expected_returns);
@@ -332,10 +557,9 @@ void vm_CALL(struct VM *const vm);
 void vm_CALL_now(struct VM *const vm);
 
 #define vm_lookup_method_throwing_source(vm, source, method_name, err_str, ...) do {\
-	struct YASL_Object index = YASL_STR(YASL_String_new_copy(vm, method_name, strlen(method_name)));\
 	struct YASL_Object maybe_mt = vm_get_metatable_index(vm, source);\
 	struct YASL_Table *mt = obj_istable(&maybe_mt) ? YASL_GETTABLE(maybe_mt) : NULL;\
-	int result = vm_lookup_method_helper(vm, mt, index);\
+	int result = vm_lookup_method_name(vm, mt, method_name);\
 	if (result) {\
 		vm_print_err_type(vm, err_str, __VA_ARGS__);\
 		vm_throw_err(vm, YASL_TYPE_ERROR);\
@@ -343,13 +567,12 @@ void vm_CALL_now(struct VM *const vm);
 } while (0)
 
 #define vm_lookup_method_throwing(vm, method_name, err_str, ...) do {\
-	struct YASL_Object index = YASL_STR(YASL_String_new_copy(vm, method_name, strlen(method_name)));\
 	vm_get_metatable(vm);\
 	struct YASL_Table *mt = vm_istable(vm) ? vm_poptable(vm) : NULL;\
 	if (!mt) {\
 		vm_pop(vm);\
 	}\
-	int result = vm_lookup_method_helper(vm, mt, index);\
+	int result = vm_lookup_method_name(vm, mt, method_name);\
 	if (result) {\
 		vm_print_err_type(vm, err_str, __VA_ARGS__);\
 		vm_throw_err(vm, YASL_TYPE_ERROR);\
@@ -358,21 +581,20 @@ void vm_CALL_now(struct VM *const vm);
 
 // TODO: make this not rely on "source" being the top of the stack.
 #define vm_call_method_now_1_top(vm, target, source, method_name, ...) do {\
-	vm_lookup_method_throwing_source(vm, source, method_name, __VA_ARGS__, vm_peektypename(vm, source));\
+	vm_lookup_method_throwing_source(vm, source, method_name, __VA_ARGS__, vm_peektypename(vm, vm->fp + 1 + source));\
 	vm_swaptop(vm);\
 	vm_INIT_CALL_offset(vm, vm->sp - 1, 1);\
 	vm_CALL(vm);\
 } while (0)
 
 #define vm_call_binop_method_now(vm, left, right, method_name, format, ...) do {\
-	struct YASL_Object index = YASL_STR(YASL_String_new_copy(vm, method_name, strlen(method_name)));\
 	vm_push(vm, left);\
 	vm_get_metatable(vm);\
 	struct YASL_Table *mt = vm_istable(vm) ? vm_poptable(vm) : NULL;\
 	if (!mt) {\
 		vm_pop(vm);\
 	}\
-	int result = vm_lookup_method_helper(vm, mt, index);\
+	int result = vm_lookup_method_name(vm, mt, method_name);\
 	if (result) {\
 		vm_push(vm, right);\
 		vm_get_metatable(vm);\
@@ -380,7 +602,7 @@ void vm_CALL_now(struct VM *const vm);
 		if (!mt) {\
 			vm_pop(vm);\
 		}\
-		result = vm_lookup_method_helper(vm, mt, index);\
+		result = vm_lookup_method_name(vm, mt, method_name);\
 	}\
 	if (result) {\
 		vm_print_err_type(vm, format, __VA_ARGS__);\
@@ -564,6 +786,40 @@ static void vm_CNCT(struct VM *const vm) {
 		vm_dec_ref(vm, &top);
 }
 
+/*
+ * Stringifies the top n values in place, then concats them with a single allocation. Values are stringified from the
+ * top down, in the same order as a right-associative chain of O_CNCT.
+ */
+static void vm_CNCT_N(struct VM *const vm) {
+	const int n = NCODE(vm);
+	const int top = vm->sp;
+	const int bottom = top - n + 1;
+
+	size_t size = 0;
+	for (int i = top; i >= bottom; i--) {
+		if (!vm_isstr(vm, i)) {
+			vm_push(vm, vm_peek(vm, i));
+			vm_stringify_top(vm);
+			struct YASL_Object str = vm_pop(vm);
+			inc_ref(&str);
+			vm_dec_ref(vm, vm->stack + i);
+			vm->stack[i] = str;
+		}
+		size += YASL_String_len(vm_peekstr(vm, i));
+	}
+
+	char *ptr = (char *)malloc(size);
+	char *curr = ptr;
+	for (int i = bottom; i <= top; i++) {
+		struct YASL_String *str = vm_peekstr(vm, i);
+		memcpy(curr, YASL_String_chars(str), YASL_String_len(str));
+		curr += YASL_String_len(str);
+	}
+
+	vm->sp = bottom - 1;
+	vm_pushstr(vm, YASL_String_new_take(vm, ptr, size));
+}
+
 #define DEFINE_COMP(name, opstr, overload_name) \
 static void vm_##name(struct VM *const vm) {\
 	struct YASL_Object right = vm_peek(vm);\
@@ -713,6 +969,35 @@ static void vm_CCONST(struct VM *const vm) {
 	vm_push(vm, ((struct YASL_Object){.type = Y_CLOSURE, .value = {.lval = closure}}));
 }
 
+static void vm_loadconstants(struct VM *const vm, const unsigned char *header, const int64_t num_constants,
+			     const bool borrow);
+
+/*
+ * Compiles the rest of the function that is being called for the first time, and patches its stub to branch to the
+ * compiled code on later calls.
+ */
+static void vm_LAZY(struct VM *const vm) {
+	struct Compiler *const compiler = &((struct YASL_State *)vm)->compiler;
+	unsigned char *const stub = vm->pc - 1;
+	unsigned char *const program = compile_lazy(compiler, vm->pc, &vm->err);
+	if (!program) {
+		// The compiler has already given the error and its line, so only say where the function is.
+		vm_print_err(vm, "In function compiled on its first call");
+		vm_throw_err(vm, YASL_SYNTAX_ERROR);
+	}
+
+	vm->headers = (unsigned char **)realloc(vm->headers, (vm->headers_size + 1) * sizeof(unsigned char *));
+	vm->headers[vm->headers_size++] = program;
+	vm_loadconstants(vm, compiler->header->items + 3*sizeof(int64_t), (int64_t)compiler->strings->count, false);
+
+	// Skip the O_FCONST, its size and the number of parameters.
+	unsigned char *const code = program + ((int64_t *)program)[0] + 1 + sizeof(int64_t) + 1;
+	const int64_t offset = code - (stub + 1 + sizeof(int64_t));
+	stub[0] = O_BR_8;
+	memcpy(stub + 1, &offset, sizeof(int64_t));
+	vm->pc = code;
+}
+
 static void vm_SLICE_list(struct VM *const vm) {
 	yasl_int len = vm_peeklist(vm, vm->sp - 2)->count;
 	yasl_int end;
@@ -862,8 +1147,19 @@ int vm_lookup_method_helper(struct VM *vm, struct YASL_Table *mt, struct YASL_Ob
 	return YASL_VALUE_ERROR;
 }
 
+static int vm_lookup_method_name(struct VM *vm, struct YASL_Table *mt, const char *method_name) {
+	if (!mt) return YASL_VALUE_ERROR;
+	struct YASL_Object search = YASL_Table_search_zstring(mt, method_name);
+	if (search.type != Y_END) {
+		vm_push(vm, search);
+		return YASL_SUCCESS;
+	}
+
+	return YASL_VALUE_ERROR;
+}
+
 static int lookup(struct VM *vm, struct YASL_Table *mt) {
-	struct YASL_Object search = YASL_Table_search_zstring_int(mt, "__get");
+	struct YASL_Object search = YASL_Table_search_zstring(mt, "__get");
 	if (search.type != Y_END) {
 		vm_push(vm, search);
 		vm_shifttopdown(vm, 2);
@@ -921,6 +1217,20 @@ static void vm_LIT8(struct VM *const vm) {
 
 static void vm_ITER_1(struct VM *const vm) {
 	struct LoopFrame *frame = &vm->loopframes[vm->loopframe_num];
+	/* str iterators are stepped directly, without a call per piece. */
+	if (obj_isuserdata(&frame->iterable) && YASL_GETUSERDATA(frame->iterable)->tag == STR_ITER_NAME &&
+	    obj_iscfn(&frame->next_fn) && YASL_GETCFN(frame->next_fn)->value == &str_iter___next) {
+		yasl_int curr = obj_getint(&frame->curr);
+		struct YASL_Object value;
+		if (str_iter_next(vm, (struct YASL_StrIter *)YASL_GETUSERDATA(frame->iterable)->data, &curr, &value)) {
+			frame->curr = YASL_INT(curr);
+			vm_push(vm, value);
+			vm_pushbool(vm, true);
+		} else {
+			vm_pushbool(vm, false);
+		}
+		return;
+	}
 	switch (frame->iterable.type) {
 	case Y_STR:
 	case Y_LIST:
@@ -1478,35 +1788,43 @@ static void vm_ECHO(struct VM *const vm) {
 	vm->sp = vm->fp + top;
 }
 
-void vm_setupconstants(struct VM *const vm) {
-	vm->num_constants = ((int64_t *)vm->code)[2];
-	vm->constants = (struct YASL_Object *)malloc(sizeof(struct YASL_Object) * vm->num_constants);
-	unsigned char *tmp = vm->code + 3*sizeof(int64_t);
-	for (int64_t i = 0; i < vm->num_constants; i++) {
+/*
+ * Loads the constants in header that vm doesn't have yet, so that it has the first num_constants of them. Strings
+ * borrow their contents from header if borrow is set.
+ */
+static void vm_loadconstants(struct VM *const vm, const unsigned char *header, const int64_t num_constants,
+			     const bool borrow) {
+	vm->constants = (struct YASL_Object *)realloc(vm->constants, sizeof(struct YASL_Object) * num_constants);
+	const unsigned char *tmp = header;
+	for (int64_t i = 0; i < num_constants; i++) {
+		const bool loaded = i < vm->num_constants;
 		switch (*tmp++) {
 		case C_STR: {
 			int64_t len = *((int64_t *) tmp);
 			tmp += sizeof(int64_t);
-			char *str = (char *) malloc((size_t) len);
-			memcpy(str, tmp, (size_t) len);
-			vm->constants[i] = YASL_STR(YASL_String_new_take(vm, str, (size_t) len));
-			inc_ref(vm->constants + i);
+			if (!loaded) {
+				vm->constants[i] = YASL_STR(borrow ?
+					YASL_StringSet_maybe_insert_borrow(vm->interned_strings, (char *) tmp, (size_t) len) :
+					YASL_StringSet_maybe_insert(vm->interned_strings, (char *) tmp, (size_t) len));
+				inc_ref(vm->constants + i);
+			}
 			tmp += len;
 			break;
 		}
 		case C_INT_1: {
-			vm->constants[i] = YASL_INT((signed char)*tmp++);
+			if (!loaded) vm->constants[i] = YASL_INT((signed char)*tmp);
+			tmp++;
 			break;
 		}
 		case C_INT_8: {
 			int64_t v = *((int64_t *) tmp);
-			vm->constants[i] = YASL_INT(v);
+			if (!loaded) vm->constants[i] = YASL_INT(v);
 			tmp += sizeof(int64_t);
 			break;
 		}
 		case C_FLOAT: {
 			yasl_float v = *((yasl_float *) tmp);
-			vm->constants[i] = YASL_FLOAT(v);
+			if (!loaded) vm->constants[i] = YASL_FLOAT(v);
 			tmp += sizeof(yasl_float);
 			break;
 		}
@@ -1514,6 +1832,13 @@ void vm_setupconstants(struct VM *const vm) {
 			break;
 		}
 	}
+	vm->num_constants = num_constants;
+}
+
+void vm_setupconstants(struct VM *const vm) {
+	vm->num_constants = 0;
+	vm->constants = NULL;
+	vm_loadconstants(vm, vm->code + 3*sizeof(int64_t), ((int64_t *)vm->code)[2], vm->code_is_image);
 }
 
 struct YASL_String *vm_lookup_interned_str(struct VM *vm, const char *chars, const size_t size) {
@@ -1521,6 +1846,10 @@ struct YASL_String *vm_lookup_interned_str(struct VM *vm, const char *chars, con
 	return string;
 }
 
+struct YASL_String *vm_lookup_interned_str_take(struct VM *vm, const char *mem, const size_t size) {
+	return YASL_StringSet_maybe_insert_take(vm->interned_strings, mem, size);
+}
+
 struct YASL_String *vm_lookup_interned_zstr(struct VM *vm, const char *chars) {
 	return vm_lookup_interned_str(vm, chars, strlen(chars));
 }
@@ -1564,6 +1893,9 @@ void vm_executenext(struct VM *const vm) {
 	case O_CCONST:
 		vm_CCONST(vm);
 		break;
+	case O_LAZY:
+		vm_LAZY(vm);
+		break;
 	case O_BOR:
 		vm_int_binop(vm, &bor, "|", OP_BIN_BAR);
 		break;
@@ -1641,6 +1973,9 @@ void vm_executenext(struct VM *const vm) {
 	case O_CNCT:
 		vm_CNCT(vm);
 		break;
+	case O_CNCT_N:
+		vm_CNCT_N(vm);
+		break;
 	case O_GT:
 		vm_GT(vm);
 		break;
@@ -1917,7 +2252,7 @@ int vm_run(struct VM *const vm) {
 	if (setjmp(*vm->buf)) {
 		vm_deinit_buf(vm);
 		if (VM_FAILED(vm))
-			printline(vm);
+			vm_printline(vm, -1);
 		return vm->status;
 	}
 
@@ -92,11 +92,17 @@ struct LoopFrame {
 	struct YASL_Object curr;
 };
 
+// Range of ints whose decimal strs are cached by int.tostr.
+#define VM_INT_STR_MIN (-128)
+#define VM_INT_STR_MAX 1023
+
 struct VM {
 	struct IO out;
 	struct IO err;
 	struct YASL_Table *metatables;
 	struct YASL_Table *globals;   // global variables
+	struct YASL_Table *modules;   // exports of required modules, keyed by resolved path
+	struct YASL_Table *evals;     // functions compiled by eval, keyed by source
 	struct YASL_Object *constants;
 	struct YASL_StringSet *interned_strings;
 	struct YASL_String *format_str;
@@ -109,6 +115,7 @@ struct VM {
 	unsigned char **headers;
 	size_t headers_size;
 	unsigned char *code;          // bytecode
+	bool code_is_image;           // code is a read-only image that outlives every string, so constants borrow from it
 	unsigned char *pc;            // program counter
 	int sp;                       // stack pointer
 	int fp;                       // frame pointer
@@ -117,10 +124,21 @@ struct VM {
 	struct Upvalue *pending;  // upvals that still need to be closed. Should be in descending order.
 	jmp_buf *buf;
 	int status;
+	unsigned num_threads;          // max threads to use for internal work, such as sorting
+	struct YASL_String *char_strs[256];  // strs of length 1, created on first use
+	struct YASL_String *int_strs[VM_INT_STR_MAX - VM_INT_STR_MIN + 1];  // decimal strs of small ints, created on first use
 };
 
 void vm_init(struct VM *const vm, unsigned char *const code, const size_t pc, const size_t datasize);
 
+/*
+ * Initialises vm with copies of the globals, metatables and builtin methods of src. Nothing on the stack of src, and
+ * none of its caches of modules and eval'd code, are copied.
+ * Returns false if src holds values that can't be copied, such as functions, closures or userdata that owns its data.
+ * These are left out of vm, which must still be cleaned up.
+ */
+bool vm_init_copy(struct VM *const vm, const struct VM *const src);
+
 void vm_cleanup(struct VM *const vm);
 
 /*
@@ -170,6 +188,8 @@ void vm_pushint(struct VM *const vm, yasl_int i);
 void vm_pushbool(struct VM *const vm, bool b);
 void vm_pushstr_bb(struct VM *const vm, YASL_ByteBuffer *bb);
 #define vm_pushstr(vm, s) vm_push(vm, YASL_STR(s))
+struct YASL_String *vm_char_str(struct VM *const vm, const char c);
+#define vm_pushchar(vm, c) vm_pushstr(vm, vm_char_str(vm, c))
 #define vm_pushlist(vm, l) vm_push(vm, YASL_LIST(l))
 #define vm_pushtable(vm, l) vm_push(vm, YASL_TABLE(l))
 #define vm_pushfn(vm, f) vm_push(vm, YASL_FN(f))
@@ -2,6 +2,7 @@
 
 #include "data-structures/YASL_String.h"
 #include "src/interpreter/methods/str_methods.h"
+#include "src/interpreter/methods/str_iter_methods.h"
 #include "src/interpreter/methods/undef_methods.h"
 #include "src/interpreter/methods/float_methods.h"
 #include "src/interpreter/methods/int_methods.h"
@@ -69,6 +70,14 @@ struct YASL_Table* str_builtins(struct VM *vm) {
 	return table;
 }
 
+struct YASL_Table* str_iter_builtins(struct VM *vm) {
+	struct YASL_Table *table = YASL_Table_new();
+#define X(name, arity) table_insert_str_cfunction(vm, table, #name, &str_iter_##name, arity);
+#include "methods/str_iter_methods.x"
+#undef X
+	return table;
+}
+
 struct YASL_Table* list_builtins(struct VM *vm) {
 	struct YASL_Table *table = YASL_Table_new();
 #define X(name, arity) table_insert_str_cfunction(vm, table, #name, &list_##name, arity);
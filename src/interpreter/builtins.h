@@ -8,6 +8,7 @@ struct YASL_Table *float_builtins(struct VM *vm);
 struct YASL_Table *int_builtins(struct VM *vm);
 struct YASL_Table *bool_builtins(struct VM *vm);
 struct YASL_Table *str_builtins(struct VM *vm);
+struct YASL_Table *str_iter_builtins(struct VM *vm);
 struct YASL_Table *list_builtins(struct VM *vm);
 struct YASL_Table *table_builtins(struct VM *vm);
 
@@ -19,7 +19,7 @@ int bool_tostr(struct YASL_State *S) {
 			YASLX_print_and_throw_err_value(S,
 							"bool.tostr expected str arg of len 1 in position 1, got str of len %"
 								PRI_SIZET
-								" ('%s').", len, str);
+								" ('%.*s').", len, (int)len, str);
 		}
 		format_char = *str;
 	}
@@ -26,8 +26,8 @@ int float_toint(struct YASL_State *S) {
 
 int float_tostr(struct YASL_State *S) {
 	yasl_float val = YASLX_checknfloat(S, "float.tostr", 0);
-	const char *ptr = float64_to_str(val);
-	YASL_pushzstr(S, ptr);
-	free((void *)ptr);
+	char buffer[YASL_FLOAT_BUFF_LEN];
+	size_t len = float64_to_buf(buffer, val);
+	YASL_pushlstr(S, buffer, len);
 	return 1;
 }
@@ -26,47 +26,111 @@ int int_toint(struct YASL_State *S) {
 }
 
 #define BUFF_LEN 67
+
+static const char DIGIT_PAIRS[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/*
+ * Writes n in decimal so that it ends just before end, two digits at a time. Returns the start of the result.
+ */
+static char *int_to_dec(char *end, yasl_int n) {
+	uint64_t u = n < 0 ? 0 - (uint64_t)n : (uint64_t)n;
+	while (u >= 100) {
+		const unsigned i = (unsigned)(u % 100) * 2;
+		u /= 100;
+		*--end = DIGIT_PAIRS[i + 1];
+		*--end = DIGIT_PAIRS[i];
+	}
+	if (u >= 10) {
+		const unsigned i = (unsigned)u * 2;
+		*--end = DIGIT_PAIRS[i + 1];
+		*--end = DIGIT_PAIRS[i];
+	} else {
+		*--end = (char)('0' + u);
+	}
+	if (n < 0) {
+		*--end = '-';
+	}
+	return end;
+}
+
+static char *int_to_hex(char *end, yasl_int n) {
+	static const char HEX_DIGITS[] = "0123456789abcdef";
+	uint64_t u = (uint64_t)n;
+	do {
+		*--end = HEX_DIGITS[u & 0xF];
+		u >>= 4;
+	} while (u);
+	*--end = 'x';
+	*--end = '0';
+	return end;
+}
+
+/*
+ * Returns the decimal str for n, which must be between VM_INT_STR_MIN and VM_INT_STR_MAX, creating it on first use.
+ */
+static struct YASL_String *int_cached_str(struct VM *vm, yasl_int n) {
+	struct YASL_String **slot = vm->int_strs + (n - VM_INT_STR_MIN);
+	if (!*slot) {
+		char buffer[8];
+		char *const end = buffer + sizeof(buffer);
+		char *start = int_to_dec(end, n);
+		*slot = YASL_String_new_copy(vm, start, (size_t)(end - start));
+		(*slot)->rc.refs++;
+	}
+	return *slot;
+}
+
 int int_tostr(struct YASL_State *S) {
 	yasl_int n = YASLX_checknint(S, "int.tostr", 0);
-	const char *format = "%" PRId64 "";
 
 	char format_char = 'd';
 	if (!YASL_isundef(S)) {
 		size_t len;
 		const char *str = YASLX_checknstr(S, "int.tostr", 1, &len);
 		if (len != 1) {
-			YASLX_print_and_throw_err_value(S, "int.tostr expected str arg of len 1 in position 1, got str of len %" PRI_SIZET " ('%s').", len, str);
+			YASLX_print_and_throw_err_value(S, "int.tostr expected str arg of len 1 in position 1, got str of len %" PRI_SIZET " ('%.*s').", len, (int)len, str);
 		}
 		format_char = *str;
 	}
 	char buffer[BUFF_LEN];
+	char *const end = buffer + BUFF_LEN;
 
-	int len = 0;
-	char *curr = buffer;
+	char *curr = end;
 	switch (format_char) {
 	case 'x':
-		format = "0x%" PRIx64 "";
-		/* fallthrough */
+		curr = int_to_hex(end, n);
+		break;
 	case 'd':
 	case 'r':
-		len = sprintf(buffer, format, n);
+		if (VM_INT_STR_MIN <= n && n <= VM_INT_STR_MAX) {
+			vm_pushstr((struct VM *)S, int_cached_str((struct VM *)S, n));
+			return 1;
+		}
+		curr = int_to_dec(end, n);
 		break;
 	case 'b':
-		curr = buffer + BUFF_LEN - 1;
 		do {
-			len++;
 			*--curr = n % 2 ? '1' : '0';
 			n /= 2;
 		} while (n);
 		*--curr = 'b';
 		*--curr = '0';
-		len += 2;
 		break;
 	default:
 		YASLX_print_and_throw_err_value(S, "Unexpected format str for int.tostr: '%c'.", format_char);
 	}
 
-	YASL_pushlstr(S, curr, len);
+	YASL_pushlstr(S, curr, (size_t)(end - curr));
 	return 1;
 }
 
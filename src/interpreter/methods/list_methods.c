@@ -5,6 +5,7 @@
 #include "data-structures/YASL_List.h"
 #include "yasl_error.h"
 #include "yasl_state.h"
+#include "util/yasl_thread.h"
 
 static struct YASL_List *YASLX_checknlist(struct YASL_State *S, const char *name, unsigned pos) {
 	if (!YASL_isnlist(S, pos)) {
@@ -398,13 +399,52 @@ int list_shuffle(struct YASL_State *S) {
 }
 
 enum SortType {
+	SORT_TYPE_ERROR = -2,
 	SORT_TYPE_STR = -1,
 	SORT_TYPE_EMPTY = 0,
-	SORT_TYPE_NUM = 1
+	SORT_TYPE_NUM = 1,
+	SORT_TYPE_INT = 2,
+	SORT_TYPE_FLOAT = 3
 };
 
+/*
+ * Returns the type of a list containing elements of type `type` once `obj` is added to it.
+ */
+static enum SortType sort_type_add(enum SortType type, const struct YASL_Object *obj) {
+	switch (obj->type) {
+	case Y_STR:
+		return type == SORT_TYPE_EMPTY || type == SORT_TYPE_STR ? SORT_TYPE_STR : SORT_TYPE_ERROR;
+	case Y_INT:
+		switch (type) {
+		case SORT_TYPE_EMPTY:
+		case SORT_TYPE_INT:
+			return SORT_TYPE_INT;
+		case SORT_TYPE_FLOAT:
+		case SORT_TYPE_NUM:
+			return SORT_TYPE_NUM;
+		default:
+			return SORT_TYPE_ERROR;
+		}
+	case Y_FLOAT:
+		switch (type) {
+		case SORT_TYPE_EMPTY:
+		case SORT_TYPE_FLOAT:
+			return SORT_TYPE_FLOAT;
+		case SORT_TYPE_INT:
+		case SORT_TYPE_NUM:
+			return SORT_TYPE_NUM;
+		default:
+			return SORT_TYPE_ERROR;
+		}
+	default:
+		return SORT_TYPE_ERROR;
+	}
+}
 
-int custom_comp(struct YASL_State *S, struct YASL_Object a, struct YASL_Object b) {
+/*
+ * Calls the comparison function on top of the stack once, returning whether a should be ordered before b.
+ */
+static bool custom_lt(struct YASL_State *S, struct YASL_Object a, struct YASL_Object b) {
 	YASL_duptop(S);
 	vm_push((struct VM *)S, a);
 	vm_push((struct VM *)S, b);
@@ -414,107 +454,366 @@ int custom_comp(struct YASL_State *S, struct YASL_Object a, struct YASL_Object b
 		YASL_print_err(S, "TypeError: Expected a function returning bool, got %s.", YASL_peektypename(S));
 		YASLX_throw_err_type(S);
 	}
-	bool a_lt_b = YASL_popbool(S);
-
-	YASL_duptop(S);
-	vm_push((struct VM *)S, b);
-	vm_push((struct VM *)S, a);
-	num_returns = YASL_functioncall(S, 2);
-	YASL_UNUSED(num_returns);
-	if (!YASL_isbool(S)) {
-		YASL_print_err(S, "TypeError: Expected a function returning bool, got %s.", YASL_peektypename(S));
-		YASLX_throw_err_type(S);
-	}
+	return YASL_popbool(S);
+}
 
-	bool a_gt_b = YASL_popbool(S);
+/*
+ * An element of a list, paired with the result of calling a key function on it.
+ */
+struct KeyedObject {
+	struct YASL_Object key;
+	struct YASL_Object value;
+};
 
-	if (a_lt_b == a_gt_b) return 0;
-	return a_lt_b ? -1 : a_gt_b ? 1 : 0;
-}
+#define DEFAULT_LT(a, b) (yasl_object_cmp(a, b) < 0)
+#define INT_LT(a, b) (obj_getint(&(a)) < obj_getint(&(b)))
+#define FLOAT_LT(a, b) (obj_getfloat(&(a)) < obj_getfloat(&(b)))
+#define STR_LT(a, b) (YASL_String_cmp(obj_getstr(&(a)), obj_getstr(&(b))) < 0)
+#define CUSTOM_LT(a, b) custom_lt(S, a, b)
+#define KEY_DEFAULT_LT(a, b) DEFAULT_LT((a).key, (b).key)
+#define KEY_INT_LT(a, b) INT_LT((a).key, (b).key)
+#define KEY_FLOAT_LT(a, b) FLOAT_LT((a).key, (b).key)
+#define KEY_STR_LT(a, b) STR_LT((a).key, (b).key)
 
-#define YASL_OBJ_COMP_REVERSE(a, b) (-yasl_object_cmp(a, b))
-#define CUSTOM_COMP(a, b) custom_comp(S, a, b)
-#define CUSTOM_COMP_REVERSE(a, b) (-custom_comp(S, a, b))
+/*
+ * Runs shorter than this are extended with a binary insertion sort before merging.
+ */
+#define SORT_MINRUN 32
+#define SORT_RUNS_SIZE(len) ((len) / SORT_MINRUN + 2)
 
-#define DEF_SORT(name, COMP) \
-static void name##sort(struct YASL_State *S, struct YASL_Object *list, const size_t len) {\
-	/* Base cases*/ \
-	struct YASL_Object tmpObj;\
-	if (len < 2) return;\
-	if (len == 2) {\
-		if (COMP(list[0], list[1]) > 0) {\
-			tmpObj = list[0];\
-			list[0] = list[1];\
-			list[1] = tmpObj;\
+/*
+ * Defines a stable natural merge sort, `name##sort`, over arrays of T, using LT as a strict less-than.
+ * Maximal ascending (or strictly descending, which are reversed in place) runs are found first, short runs are
+ * extended to SORT_MINRUN elements, and adjacent runs are then merged pairwise until one remains. Sorted and
+ * reverse-sorted input is therefore handled in a single pass. `scratch` must have room for `len` elements, and
+ * `runs` for SORT_RUNS_SIZE(len) elements.
+ */
+#define DEF_SORT(name, T, LT) \
+static void name##_insertionsort(struct YASL_State *S, T *list, size_t sorted, const size_t len) {\
+	YASL_UNUSED(S);\
+	for (; sorted < len; sorted++) {\
+		const T tmpObj = list[sorted];\
+		size_t lo = 0;\
+		size_t hi = sorted;\
+		while (lo < hi) {\
+			const size_t mid = lo + (hi - lo) / 2;\
+			if (LT(tmpObj, list[mid])) hi = mid;\
+			else lo = mid + 1;\
 		}\
-		return;\
+		memmove(list + lo + 1, list + lo, (sorted - lo) * sizeof(T));\
+		list[lo] = tmpObj;\
 	}\
+}\
 \
-	/* YASL_Set sorting bounds */\
-	size_t left = 0;\
-	size_t right = len - 1;\
-\
-	/* Determine random midpoint to use (good average case) */\
-	const size_t randIndex = rand() % len;\
-	const struct YASL_Object mid = list[randIndex];\
+static size_t name##_countrun(struct YASL_State *S, T *list, const size_t len) {\
+	YASL_UNUSED(S);\
+	size_t end = 1;\
+	if (len < 2) return len;\
+	if (LT(list[1], list[0])) {\
+		while (end + 1 < len && LT(list[end + 1], list[end])) end++;\
+		for (size_t i = 0, j = end; i < j; i++, j--) {\
+			T tmpObj = list[i];\
+			list[i] = list[j];\
+			list[j] = tmpObj;\
+		}\
+	} else {\
+		while (end + 1 < len && !LT(list[end + 1], list[end])) end++;\
+	}\
+	return end + 1;\
+}\
 \
-	/* Determine exact number of items less than mid (mid's index)\
-	   Furthermore, ensure list is not homogeneous to avoid infinite loops */\
-	size_t ltCount = 0;\
-	bool seenDifferent = false;\
-	for (size_t i = 0; i < len; i++) {\
-		if (COMP(list[i], mid) < 0) ltCount++;\
-		if (seenDifferent == 0 && COMP(list[0], list[i]) != 0) seenDifferent = true;\
+static void name##_merge(struct YASL_State *S, T *list, const size_t mid, const size_t len, T *scratch) {\
+	YASL_UNUSED(S);\
+	/* Runs that are already in order relative to each other need no work. */\
+	if (!LT(list[mid], list[mid - 1])) return;\
+	memcpy(scratch, list, mid * sizeof(T));\
+	size_t i = 0, j = mid, k = 0;\
+	while (i < mid && j < len) {\
+		if (LT(list[j], scratch[i])) list[k++] = list[j++];\
+		else list[k++] = scratch[i++];\
 	}\
-	if (!seenDifferent) return;\
+	memcpy(list + k, scratch + i, (mid - i) * sizeof(T));\
+}\
 \
-	/* Ensure all items are on the correct side of mid */\
-	while (left < right) {\
-		while (COMP(list[left], mid) < 0) left++;\
-		while (COMP(list[right], mid) >= 0) {\
-			if (right == 0) break;\
-			right--;\
+static void name##sort(struct YASL_State *S, T *list, const size_t len, T *scratch, size_t *runs) {\
+	if (len < 2) return;\
+	size_t num_runs = 0;\
+	for (size_t start = 0; start < len; ) {\
+		size_t run = name##_countrun(S, list + start, len - start);\
+		if (run < SORT_MINRUN) {\
+			const size_t forced = len - start < SORT_MINRUN ? len - start : SORT_MINRUN;\
+			name##_insertionsort(S, list + start, run, forced);\
+			run = forced;\
 		}\
+		runs[num_runs++] = start;\
+		start += run;\
+	}\
+	runs[num_runs] = len;\
 \
-		int cmp = COMP(list[left], list[right]);\
-		if (cmp > 0 && left < right) {\
-			tmpObj = list[right];\
-			list[right] = list[left];\
-			list[left++] = tmpObj;\
-			if (right == 0) break;\
-			right--;\
-		} else if (cmp == 0) {\
-			left++;\
-			if (right == 0) break;\
-			right--;\
+	while (num_runs > 1) {\
+		size_t merged = 0;\
+		size_t i;\
+		for (i = 0; i + 1 < num_runs; i += 2) {\
+			name##_merge(S, list + runs[i], runs[i + 1] - runs[i], runs[i + 2] - runs[i], scratch);\
+			runs[merged++] = runs[i];\
 		}\
+		if (i < num_runs) runs[merged++] = runs[i];\
+		runs[merged] = len;\
+		num_runs = merged;\
 	}\
-\
-	/* Let sort() finish that for us...*/ \
-	name##sort(S, list, ltCount);\
-	name##sort(S, &list[ltCount], len - ltCount);\
 }
 
-DEF_SORT(default, yasl_object_cmp)
-// DEF_SORT(reverse, YASL_OBJ_COMP_REVERSE)
-DEF_SORT(fn, CUSTOM_COMP)
-// DEF_SORT(fn_reverse, CUSTOM_COMP_REVERSE)
+DEF_SORT(default, struct YASL_Object, DEFAULT_LT)
+DEF_SORT(int, struct YASL_Object, INT_LT)
+DEF_SORT(float, struct YASL_Object, FLOAT_LT)
+DEF_SORT(str, struct YASL_Object, STR_LT)
+DEF_SORT(fn, struct YASL_Object, CUSTOM_LT)
+DEF_SORT(keydefault, struct KeyedObject, KEY_DEFAULT_LT)
+DEF_SORT(keyint, struct KeyedObject, KEY_INT_LT)
+DEF_SORT(keyfloat, struct KeyedObject, KEY_FLOAT_LT)
+DEF_SORT(keystr, struct KeyedObject, KEY_STR_LT)
+
+/*
+ * Int lists at least this long are sorted with a radix sort instead.
+ */
+#define RADIX_SORT_THRESHOLD 256
+
+/*
+ * LSD radix sort on the bytes of each int, with the sign bit flipped so that negative numbers order first. Passes
+ * in which every element has the same byte are skipped.
+ */
+static void int_radixsort(struct YASL_Object *list, const size_t len, struct YASL_Object *scratch) {
+	size_t counts[sizeof(yasl_int)][256] = { { 0 } };
+	for (size_t i = 0; i < len; i++) {
+		uint64_t key = (uint64_t)obj_getint(list + i) ^ ((uint64_t)1 << 63);
+		for (size_t b = 0; b < sizeof(yasl_int); b++) {
+			counts[b][(key >> (8 * b)) & 0xFF]++;
+		}
+	}
+
+	struct YASL_Object *src = list;
+	struct YASL_Object *dest = scratch;
+	for (size_t b = 0; b < sizeof(yasl_int); b++) {
+		size_t *count = counts[b];
+		uint64_t first = ((uint64_t)obj_getint(src) ^ ((uint64_t)1 << 63)) >> (8 * b) & 0xFF;
+		if (count[first] == len) continue;
+
+		size_t offset = 0;
+		for (size_t digit = 0; digit < 256; digit++) {
+			const size_t tmp = count[digit];
+			count[digit] = offset;
+			offset += tmp;
+		}
+
+		for (size_t i = 0; i < len; i++) {
+			uint64_t key = (uint64_t)obj_getint(src + i) ^ ((uint64_t)1 << 63);
+			dest[count[(key >> (8 * b)) & 0xFF]++] = src[i];
+		}
+
+		struct YASL_Object *tmp = src;
+		src = dest;
+		dest = tmp;
+	}
+
+	if (src != list) {
+		memcpy(list, src, len * sizeof(struct YASL_Object));
+	}
+}
+
+/*
+ * Sorts `len` numbers or strings of the given type. This runs no YASL code, so it is safe to call from any thread.
+ */
+static void sort_native(enum SortType type, struct YASL_Object *list, const size_t len, struct YASL_Object *scratch,
+			size_t *runs) {
+	switch (type) {
+	case SORT_TYPE_INT:
+		if (len >= RADIX_SORT_THRESHOLD) {
+			int_radixsort(list, len, scratch);
+		} else {
+			intsort(NULL, list, len, scratch, runs);
+		}
+		break;
+	case SORT_TYPE_FLOAT:
+		floatsort(NULL, list, len, scratch, runs);
+		break;
+	case SORT_TYPE_STR:
+		strsort(NULL, list, len, scratch, runs);
+		break;
+	case SORT_TYPE_NUM:
+		defaultsort(NULL, list, len, scratch, runs);
+		break;
+	default:
+		break;
+	}
+}
+
+static void merge_native(enum SortType type, struct YASL_Object *list, const size_t mid, const size_t len,
+			 struct YASL_Object *scratch) {
+	switch (type) {
+	case SORT_TYPE_INT:
+		int_merge(NULL, list, mid, len, scratch);
+		break;
+	case SORT_TYPE_FLOAT:
+		float_merge(NULL, list, mid, len, scratch);
+		break;
+	case SORT_TYPE_STR:
+		str_merge(NULL, list, mid, len, scratch);
+		break;
+	case SORT_TYPE_NUM:
+		default_merge(NULL, list, mid, len, scratch);
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * When more than one thread is allowed, lists are split so that each thread sorts at least this many elements.
+ */
+#define PARALLEL_SORT_MIN_CHUNK (1 << 15)
+
+struct SortTask {
+	enum SortType type;
+	struct YASL_Object *list;
+	struct YASL_Object *scratch;
+	size_t mid;
+	size_t len;
+};
+
+static void sort_task_sort(void *ptr) {
+	struct SortTask *task = (struct SortTask *)ptr;
+	size_t *runs = (size_t *)malloc(SORT_RUNS_SIZE(task->len) * sizeof(size_t));
+	sort_native(task->type, task->list, task->len, task->scratch, runs);
+	free(runs);
+}
+
+static void sort_task_merge(void *ptr) {
+	struct SortTask *task = (struct SortTask *)ptr;
+	merge_native(task->type, task->list, task->mid, task->len, task->scratch);
+}
+
+/*
+ * Splits the list into one chunk per thread and sorts the chunks concurrently, then merges pairs of adjacent chunks
+ * concurrently until only one is left.
+ */
+static void sort_parallel(enum SortType type, struct YASL_Object *list, const size_t len, struct YASL_Object *scratch,
+			  const size_t num_threads) {
+	struct SortTask *tasks = (struct SortTask *)malloc(num_threads * sizeof(struct SortTask));
+	size_t *bounds = (size_t *)malloc((num_threads + 1) * sizeof(size_t));
+	for (size_t i = 0; i <= num_threads; i++) {
+		bounds[i] = len / num_threads * i + len % num_threads * i / num_threads;
+	}
+
+	for (size_t i = 0; i < num_threads; i++) {
+		tasks[i] = (struct SortTask) { type, list + bounds[i], scratch + bounds[i], 0, bounds[i + 1] - bounds[i] };
+	}
+	yasl_thread_run_all(&sort_task_sort, tasks, sizeof(struct SortTask), num_threads);
+
+	size_t num_chunks = num_threads;
+	while (num_chunks > 1) {
+		size_t num_tasks = 0;
+		size_t merged = 0;
+		size_t i;
+		for (i = 0; i + 1 < num_chunks; i += 2) {
+			tasks[num_tasks++] = (struct SortTask) {
+				type, list + bounds[i], scratch + bounds[i], bounds[i + 1] - bounds[i], bounds[i + 2] - bounds[i]
+			};
+			bounds[merged++] = bounds[i];
+		}
+		if (i < num_chunks) bounds[merged++] = bounds[i];
+		bounds[merged] = len;
+		num_chunks = merged;
+		yasl_thread_run_all(&sort_task_merge, tasks, sizeof(struct SortTask), num_tasks);
+	}
+
+	free(tasks);
+	free(bounds);
+}
+
+static const char *const SORT_BUFFER_NAME = "list.sort buffer";
+
+/*
+ * Holds a snapshot of a list while user code runs during a sort. It lives on the stack as userdata, so that the
+ * references it owns are released even if the user code throws. The first num_refs objects in refs are the ones it
+ * owns; a sort that can throw part way through must work on a copy of them, since it may leave its array holding some
+ * elements twice and others not at all.
+ */
+struct SortBuffer {
+	size_t num_refs;
+	struct YASL_Object *refs;
+	size_t *runs;
+};
+
+static void sort_buffer_del(struct YASL_State *S, void *ptr) {
+	YASL_UNUSED(S);
+	struct SortBuffer *buffer = (struct SortBuffer *)ptr;
+	for (size_t i = 0; i < buffer->num_refs; i++) {
+		dec_ref(buffer->refs + i);
+	}
+	free(buffer->refs);
+	free(buffer->runs);
+	free(buffer);
+}
+
+/*
+ * Pushes a new SortBuffer with room for `len` elements of `size` objects each, followed by room to sort a copy of them,
+ * and then a copy of the function at position 1.
+ */
+static struct SortBuffer *sort_buffer_push(struct YASL_State *S, size_t len, size_t size) {
+	struct SortBuffer *buffer = (struct SortBuffer *)malloc(sizeof(struct SortBuffer));
+	buffer->num_refs = 0;
+	buffer->refs = (struct YASL_Object *)malloc(3 * len * size * sizeof(struct YASL_Object));
+	buffer->runs = (size_t *)malloc(SORT_RUNS_SIZE(len) * sizeof(size_t));
+	YASL_pushuserdata(S, buffer, SORT_BUFFER_NAME, sort_buffer_del);
+	vm_push((struct VM *)S, vm_peek_fp((struct VM *)S, 1));
+	return buffer;
+}
+
+/*
+ * Replaces the contents of `list` with the `len` objects in `items`, taking ownership of their references.
+ */
+static void sort_replace_items(struct YASL_State *S, struct YASL_List *list, struct YASL_Object *items,
+			       size_t len, size_t stride) {
+	FOR_LIST(i, obj, list) vm_dec_ref(&S->vm, &obj);
+	if (list->size < len) {
+		list->items = (struct YASL_Object *)realloc(list->items, len * sizeof(struct YASL_Object));
+		list->size = len;
+	}
+	for (size_t i = 0; i < len; i++) {
+		list->items[i] = items[i * stride];
+	}
+	list->count = len;
+}
+
+static int list_sort_custom(struct YASL_State *S, struct YASL_List *list) {
+	/*
+	 * We sort a snapshot of the list, so that the sort function modifying the list doesn't cause a segfault.
+	 */
+	const size_t len = list->count;
+	struct SortBuffer *buffer = sort_buffer_push(S, len, 1);
+	FOR_LIST(i, obj, list) {
+		buffer->refs[i] = obj;
+		inc_ref(&obj);
+	}
+	buffer->num_refs = len;
+
+	// The comparison function may throw in the middle of a merge, so the owned references are left in their order.
+	struct YASL_Object *items = buffer->refs + len;
+	memcpy(items, buffer->refs, len * sizeof(struct YASL_Object));
+	fnsort(S, items, len, items + len, buffer->runs);
+
+	sort_replace_items(S, list, items, len, 1);
+	buffer->num_refs = 0;
+	YASL_pop(S);
+	YASL_pop(S);
+	return 0;
+}
 
-// TODO: clean this up
 int list_sort(struct YASL_State *S) {
 	struct YASL_List *list = YASLX_checknlist(S, "list.sort", 0);
 
 	if (!YASL_isnundef(S, 1)) {
-		/*
-		 * We save the old value of list before calling the custom sort function, so that the sort function
-		 * modifying the list doesn't cause a segfault. To the custom sort function, it just sees an empty list.
-		 */
-		const struct YASL_List tmp = *list;
-		*list = (struct YASL_List) { 0, 0, NULL };
-		fnsort(S, tmp.items, tmp.count);
-		if (list->items) YASL_List_del_data(S, list->items);
-		*list = tmp;
-		return 0;
+		return list_sort_custom(S, list);
 	}
 
 	if (YASL_List_len(list) <= 1) {
@@ -522,37 +821,88 @@ int list_sort(struct YASL_State *S) {
 	}
 
 	enum SortType type = SORT_TYPE_EMPTY;
-
-	int err = 0;
-	for (size_t i = 0; i < list->count; i++) {
-		switch (list->items[i].type) {
-		case Y_STR:
-			if (type == SORT_TYPE_EMPTY) {
-				type = SORT_TYPE_STR;
-			} else if (type == SORT_TYPE_NUM) {
-				err = -1;
-			}
-			break;
-		case Y_INT:
-		case Y_FLOAT:
-			if (type == SORT_TYPE_EMPTY) {
-				type = SORT_TYPE_NUM;
-			} else if (type == SORT_TYPE_STR) {
-				err = -1;
-			}
-			break;
-		default: err = -1;
+	FOR_LIST(i, obj, list) {
+		type = sort_type_add(type, &obj);
+		if (type == SORT_TYPE_ERROR) {
+			YASLX_print_and_throw_err_value(S, "%s expected a list of all numbers or all strings.", "list.sort");
 		}
+	}
 
-		if (err != 0) {
-			YASLX_print_and_throw_err_value(S, "%s expected a list of all numbers or all strings.", "list.sort");
+	struct YASL_Object *scratch = (struct YASL_Object *)malloc(list->count * sizeof(struct YASL_Object));
+	size_t num_threads = list->count / PARALLEL_SORT_MIN_CHUNK;
+	if (num_threads > S->vm.num_threads) num_threads = S->vm.num_threads;
+	if (num_threads > 1) {
+		sort_parallel(type, list->items, list->count, scratch, num_threads);
+	} else {
+		size_t *runs = (size_t *)malloc(SORT_RUNS_SIZE(list->count) * sizeof(size_t));
+		sort_native(type, list->items, list->count, scratch, runs);
+		free(runs);
+	}
+	free(scratch);
+
+	return 0;
+}
+
+int list_sortby(struct YASL_State *S) {
+	struct YASL_List *list = YASLX_checknlist(S, "list.sortby", 0);
+	const size_t len = list->count;
+
+	/*
+	 * The key function is called exactly once per element, and the (key, element) pairs are then sorted natively.
+	 * As with a custom comparison function, we work on a snapshot so that the key function can't invalidate it.
+	 * Comparing keys can't throw, so the pairs are sorted in place.
+	 */
+	struct SortBuffer *buffer = sort_buffer_push(S, len, 2);
+	struct KeyedObject *keyed = (struct KeyedObject *)buffer->refs;
+	enum SortType type = SORT_TYPE_EMPTY;
+	size_t count = 0;
+	for (; count < len && count < list->count; count++) {
+		keyed[count].value = list->items[count];
+		keyed[count].key = YASL_UNDEF();
+		inc_ref(&keyed[count].value);
+		buffer->num_refs = 2 * (count + 1);
+
+		YASL_duptop(S);
+		vm_push((struct VM *)S, keyed[count].value);
+		int num_returns = YASL_functioncall(S, 1);
+		YASL_UNUSED(num_returns);
+		keyed[count].key = vm_pop((struct VM *)S);
+		inc_ref(&keyed[count].key);
+
+		type = sort_type_add(type, &keyed[count].key);
+		if (type == SORT_TYPE_ERROR) {
+			YASLX_print_and_throw_err_value(S, "%s expected a key function returning all numbers or all strings.", "list.sortby");
 		}
 	}
 
-	if (type != SORT_TYPE_EMPTY) {
-		defaultsort(S, list->items, list->count);
+	if (list->count != len) {
+		YASLX_print_and_throw_err_value(S, "%s expected a key function that does not change the length of the list.", "list.sortby");
+	}
+
+	switch (type) {
+	case SORT_TYPE_INT:
+		keyintsort(S, keyed, count, keyed + len, buffer->runs);
+		break;
+	case SORT_TYPE_FLOAT:
+		keyfloatsort(S, keyed, count, keyed + len, buffer->runs);
+		break;
+	case SORT_TYPE_STR:
+		keystrsort(S, keyed, count, keyed + len, buffer->runs);
+		break;
+	case SORT_TYPE_NUM:
+		keydefaultsort(S, keyed, count, keyed + len, buffer->runs);
+		break;
+	default:
+		break;
 	}
 
+	for (size_t i = 0; i < count; i++) {
+		vm_dec_ref(&S->vm, &keyed[i].key);
+	}
+	sort_replace_items(S, list, &keyed[0].value, count, 2);
+	buffer->num_refs = 0;
+	YASL_pop(S);
+	YASL_pop(S);
 	return 0;
 }
 
@@ -13,6 +13,7 @@ X(remove, 2)
 X(clear, 1)
 X(join, 2)
 X(sort, 2)
+X(sortby, 2)
 X(spread, 1)
 X(count, 2)
 X(insert, 3)
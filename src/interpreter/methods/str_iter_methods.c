@@ -0,0 +1,168 @@
+#include "str_iter_methods.h"
+
+#include <string.h>
+
+#include "yasl.h"
+#include "yasl_aux.h"
+#include "yasl_state.h"
+#include "data-structures/YASL_String.h"
+#include "util/yasl_ascii.h"
+
+const char *const STR_ITER_NAME = "str.iter";
+
+struct YASL_StrIter {
+	struct YASL_Object str;
+	struct YASL_Object sep;
+	enum StrIterKind kind;
+	struct StrSearcher searcher;  // needle points into sep, which we hold a reference to
+};
+
+static void str_iter_del(struct YASL_State *S, void *ptr) {
+	YASL_UNUSED(S);
+	struct YASL_StrIter *iter = (struct YASL_StrIter *)ptr;
+	dec_ref(&iter->str);
+	dec_ref(&iter->sep);
+	free(iter);
+}
+
+void str_iter_push(struct YASL_State *S, struct YASL_String *str, struct YASL_String *sep, enum StrIterKind kind) {
+	struct VM *vm = (struct VM *)S;
+	struct YASL_StrIter *iter = (struct YASL_StrIter *)malloc(sizeof(struct YASL_StrIter));
+	iter->str = YASL_STR(str);
+	iter->sep = sep ? YASL_STR(sep) : YASL_UNDEF();
+	iter->kind = kind;
+	inc_ref(&iter->str);
+	inc_ref(&iter->sep);
+	if (sep) {
+		str_searcher_init(&iter->searcher, YASL_String_chars(sep), YASL_String_len(sep));
+	}
+
+	struct YASL_Object mt = YASL_Table_search_zstring(vm->metatables, STR_ITER_NAME);
+	vm_push(vm, YASL_USERDATA(ud_new(iter, STR_ITER_NAME, YASL_GETUSERDATA(mt), str_iter_del)));
+}
+
+bool str_iter_next(struct VM *vm, struct YASL_StrIter *iter, yasl_int *curr, struct YASL_Object *value) {
+	struct YASL_String *str = obj_getstr(&iter->str);
+	const char *chars = YASL_String_chars(str);
+	const size_t len = YASL_String_len(str);
+	if (*curr < 0 || (size_t)*curr > len) return false;
+	size_t start = (size_t)*curr;
+
+	switch (iter->kind) {
+	case STR_ITER_SPLIT: {
+		// The piece after the last separator ends at len, so the end of the loop is marked by len + 1.
+		const char *found = str_searcher_find(&iter->searcher, chars + start, len - start);
+		const size_t end = found ? (size_t)(found - chars) : len;
+		*value = YASL_STR(YASL_String_new_substring(vm, str, start, end));
+		*curr = found ? end + YASL_String_len(obj_getstr(&iter->sep)) : len + 1;
+		return true;
+	}
+	case STR_ITER_SPLIT_SPACE: {
+		start += ascii_span_space(chars + start, len - start);
+		if (start >= len) return false;
+		const size_t end = start + ascii_cspan_space(chars + start, len - start);
+		*value = YASL_STR(YASL_String_new_substring(vm, str, start, end));
+		*curr = end;
+		return true;
+	}
+	case STR_ITER_LINES: {
+		if (start >= len) return false;
+		const char *found = (const char *)memchr(chars + start, '\n', len - start);
+		size_t end = found ? (size_t)(found - chars) : len;
+		*curr = found ? end + 1 : len;
+		if (found && end > start && chars[end - 1] == '\r') end--;
+		*value = YASL_STR(YASL_String_new_substring(vm, str, start, end));
+		return true;
+	}
+	case STR_ITER_BYTES:
+		if (start >= len) return false;
+		*value = YASL_INT((unsigned char)chars[start]);
+		*curr = start + 1;
+		return true;
+	}
+	return false;
+}
+
+int str_iter___next(struct YASL_State *S) {
+	struct YASL_StrIter *iter = (struct YASL_StrIter *)YASLX_checknuserdata(S, STR_ITER_NAME, "str.iter.__next", 0);
+	yasl_int curr = YASLX_checknint(S, "str.iter.__next", 1);
+
+	struct YASL_Object value;
+	if (!str_iter_next((struct VM *)S, iter, &curr, &value)) {
+		YASL_pushbool(S, false);
+		return 1;
+	}
+
+	YASL_pushint(S, curr);
+	vm_push((struct VM *)S, value);
+	YASL_pushbool(S, true);
+	return 3;
+}
+
+int str_iter___iter(struct YASL_State *S) {
+	YASLX_checknuserdata(S, STR_ITER_NAME, "str.iter.__iter", 0);
+	YASL_pushcfunction(S, &str_iter___next, 2);
+	YASL_pushint(S, 0);
+	return 2;
+}
+
+int str_iter_tolist(struct YASL_State *S) {
+	struct YASL_StrIter *iter = (struct YASL_StrIter *)YASLX_checknuserdata(S, STR_ITER_NAME, "str.iter.tolist", 0);
+
+	YASL_pushlist(S);
+	struct YASL_List *list = vm_peeklist((struct VM *)S);
+	yasl_int curr = 0;
+	struct YASL_Object value;
+	while (str_iter_next((struct VM *)S, iter, &curr, &value)) {
+		YASL_List_push(list, value);
+	}
+	return 1;
+}
+
+// Writes str to dest as a quoted str literal, and returns the end of what was written.
+static char *str_iter_quote(char *dest, struct YASL_Object *str) {
+	*dest++ = '\'';
+	dest = ascii_escape(dest, YASL_String_chars(obj_getstr(str)), YASL_String_len(obj_getstr(str)));
+	*dest++ = '\'';
+	return dest;
+}
+
+int str_iter_tostr(struct YASL_State *S) {
+	struct YASL_StrIter *iter = (struct YASL_StrIter *)YASLX_checknuserdata(S, STR_ITER_NAME, "str.iter.tostr", 0);
+
+	const char *method = "";
+	switch (iter->kind) {
+	case STR_ITER_SPLIT:
+		method = "->splititer(";
+		break;
+	case STR_ITER_SPLIT_SPACE:
+		method = "->splititer()";
+		break;
+	case STR_ITER_LINES:
+		method = "->lines()";
+		break;
+	case STR_ITER_BYTES:
+		method = "->bytes()";
+		break;
+	}
+
+	struct YASL_String *str = obj_getstr(&iter->str);
+	size_t size = ascii_escaped_len(YASL_String_chars(str), YASL_String_len(str)) + 2 + strlen(method);
+	if (iter->kind == STR_ITER_SPLIT) {
+		struct YASL_String *sep = obj_getstr(&iter->sep);
+		size += ascii_escaped_len(YASL_String_chars(sep), YASL_String_len(sep)) + 3;
+	}
+
+	// Shows the call that made the iterator, such as 'a,b'->splititer(',').
+	char *buffer = (char *)malloc(size);
+	char *curr = str_iter_quote(buffer, &iter->str);
+	memcpy(curr, method, strlen(method));
+	curr += strlen(method);
+	if (iter->kind == STR_ITER_SPLIT) {
+		curr = str_iter_quote(curr, &iter->sep);
+		*curr++ = ')';
+	}
+
+	vm_pushstr((struct VM *)S, YASL_String_new_take((struct VM *)S, buffer, (size_t)(curr - buffer)));
+	return 1;
+}
@@ -0,0 +1,37 @@
+#ifndef YASL_STR_ITER_METHODS_H_
+#define YASL_STR_ITER_METHODS_H_
+
+#include "yasl_conf.h"
+#include "yasl_include.h"
+
+struct YASL_State;
+struct YASL_String;
+struct YASL_Object;
+struct VM;
+
+extern const char *const STR_ITER_NAME;
+
+/*
+ * Lazy iterators over the pieces of a str, returned by str.splititer, str.lines and str.bytes. The loop state is the
+ * byte offset of the next piece, so nothing is built before the loop asks for it.
+ */
+enum StrIterKind {
+	STR_ITER_SPLIT,        // pieces between occurrences of a separator
+	STR_ITER_SPLIT_SPACE,  // runs of non-whitespace
+	STR_ITER_LINES,        // lines, without their "\n" or "\r\n"
+	STR_ITER_BYTES         // each byte, as an int
+};
+
+struct YASL_StrIter;
+
+// Pushes a new iterator over str. sep is only used by STR_ITER_SPLIT, and must be non-empty.
+void str_iter_push(struct YASL_State *S, struct YASL_String *str, struct YASL_String *sep, enum StrIterKind kind);
+
+// Sets value to the piece starting at *curr and advances *curr past it. Returns false once there are no more pieces.
+bool str_iter_next(struct VM *vm, struct YASL_StrIter *iter, yasl_int *curr, struct YASL_Object *value);
+
+#define X(name, ...) int str_iter_##name(struct YASL_State *S);
+#include "str_iter_methods.x"
+#undef X
+
+#endif
@@ -0,0 +1,4 @@
+X(__iter, 1)
+X(__next, 2)
+X(tolist, 1)
+X(tostr, 2)
@@ -8,6 +8,9 @@
 #include "yasl_include.h"
 #include "src/interpreter/yasl_types.h"
 #include "yasl_state.h"
+#include "util/yasl_ascii.h"
+#include "util/yasl_utf8.h"
+#include "str_iter_methods.h"
 
 #undef min
 
@@ -33,9 +36,9 @@ int str___get(struct YASL_State *S) {
 		YASLX_print_and_throw_err_value(S, "unable to index str of length %" PRI_SIZET " with index %ld.", len, (long)index);
 	} else {
 		if (index >= 0) {
-			vm_pushstr(vm, YASL_String_new_substring(vm, str, index, index + 1));
+			vm_pushchar(vm, YASL_String_chars(str)[index]);
 		} else {
-			vm_pushstr(vm, YASL_String_new_substring(vm, str, index + len, index + len + 1));
+			vm_pushchar(vm, YASL_String_chars(str)[index + len]);
 		}
 	}
 	return 1;
@@ -58,7 +61,7 @@ static int str___next(struct YASL_State *S) {
 	}
 
 	YASL_pushint(S, curr + 1);
-	YASL_pushlstr(S, str + curr, 1);
+	vm_pushchar((struct VM *)S, str[curr]);
 	YASL_pushbool(S, true);
 	return 3;
 }
@@ -100,7 +103,11 @@ int str_tolist(struct YASL_State *S) {
 	const size_t len = YASL_String_len(str);
 	YASL_pushlist(S);
 	for (size_t i = 0; i < len; i+= size) {
-		YASL_pushlstr(S, YASL_String_chars(str) + i, min(size, len - i));
+		if (size == 1) {
+			vm_pushchar((struct VM *)S, YASL_String_chars(str)[i]);
+		} else {
+			YASL_pushlstr(S, YASL_String_chars(str) + i, min(size, len - i));
+		}
 		YASL_listpush(S);
 	}
 	return 1;
@@ -110,7 +117,7 @@ int str_spread(struct YASL_State *S) {
 	size_t len;
 	const char *str = YASLX_checknstr(S, "str.spread", 0, &len);
 	for (size_t i = 0; i < len; i++) {
-		YASL_pushlstr(S, str + i, 1);
+		vm_pushchar((struct VM *)S, str[i]);
 	}
 	return (int)len;
 }
@@ -133,42 +140,13 @@ int str_tostr(struct YASL_State *S) {
 		YASLX_print_and_throw_err_value(S, "Unexpected format str: '%c'.", *fmt);
 	}
 
-	size_t buffer_size = str_len + 2;
-	char *buffer = (char *)malloc(buffer_size);
-	size_t curr = 0;
-	buffer[curr++] = '\'';
-	for (size_t i = 0; i < str_len; i++, curr++) {
-		const unsigned char c = (unsigned char)str_chars[i];
-		switch (c) {
-#define X(escape, c) case escape: buffer = (char *)realloc(buffer, ++buffer_size); buffer[curr++] = '\\'; buffer[curr] = c; continue;
-#include "escapes.x"
-#undef X
-		default:
-			break;
-		}
-
-		if (!isprint(c)) {
-			char tmp[3] = { '0', '0', '\0' };
-			sprintf(tmp + (c < 16), "%x", c);
-			buffer_size += 3;
-			buffer = (char *)realloc(buffer, buffer_size);
-			buffer[curr++] = '\\';
-			buffer[curr++] = 'x';
-			memcpy(buffer + curr, tmp, 2);
-			curr += 1;
-			continue;
-		}
-
-		if (c == '\'') {
-			buffer = (char *)realloc(buffer, ++buffer_size);
-			buffer[curr++] = '\\';
-		}
-		buffer[curr] = c;
-	}
-	buffer[curr++] = '\'';
+	char *buffer = (char *)malloc(ascii_escaped_len(str_chars, str_len) + 2);
+	char *curr = buffer;
+	*curr++ = '\'';
+	curr = ascii_escape(curr, str_chars, str_len);
+	*curr++ = '\'';
 
-	YASL_pushlstr(S, buffer, curr);
-	free(buffer);
+	vm_pushstr((struct VM *)S, YASL_String_new_take((struct VM *)S, buffer, (size_t)(curr - buffer)));
 	return 1;
 }
 
@@ -464,3 +442,106 @@ int str_rep(struct YASL_State *S) {
 	vm_pushstr((struct VM *) S, YASL_String_rep_fast((struct VM *)S, string, num));
 	return 1;
 }
+
+static size_t checkutf8len(struct YASL_State *S, const char *name, struct YASL_String *str) {
+	const size_t len = YASL_String_utf8_len(str);
+	if (len == UTF8_INVALID) {
+		YASLX_print_and_throw_err_value(S, "%s expected valid UTF-8 as arg 0.", name);
+	}
+	return len;
+}
+
+static void push_utf8_substring(struct YASL_State *S, struct YASL_String *str, size_t start, size_t end) {
+	const size_t start_offset = YASL_String_utf8_offset(str, start);
+	const size_t end_offset = YASL_String_utf8_offset(str, end);
+	vm_pushstr((struct VM *)S, YASL_String_new_substring((struct VM *)S, str, start_offset, end_offset));
+}
+
+int str_ulen(struct YASL_State *S) {
+	struct YASL_String *str = checkstr(S, "str.ulen", 0);
+	YASL_pushint(S, (yasl_int)checkutf8len(S, "str.ulen", str));
+	return 1;
+}
+
+int str_uget(struct YASL_State *S) {
+	struct YASL_String *str = checkstr(S, "str.uget", 0);
+	yasl_int index = YASLX_checknint(S, "str.uget", 1);
+	const yasl_int len = (yasl_int)checkutf8len(S, "str.uget", str);
+
+	if (index < -len || index >= len) {
+		YASLX_print_and_throw_err_value(S, "unable to index str of length %" PRId64 " with index %" PRId64 ".", len, index);
+	}
+
+	if (index < 0) index += len;
+	push_utf8_substring(S, str, (size_t)index, (size_t)index + 1);
+	return 1;
+}
+
+int str_uslice(struct YASL_State *S) {
+	struct YASL_String *str = checkstr(S, "str.uslice", 0);
+	const yasl_int len = (yasl_int)checkutf8len(S, "str.uslice", str);
+	yasl_int start = YASLX_checknoptint(S, "str.uslice", 1, 0);
+	yasl_int end = YASLX_checknoptint(S, "str.uslice", 2, len);
+
+	if (start < 0) start += len;
+	if (start < 0) start = 0;
+	if (end < 0) end += len;
+	if (end > len) end = len;
+
+	if (start >= end) {
+		YASL_pushlit(S, "");
+		return 1;
+	}
+
+	push_utf8_substring(S, str, (size_t)start, (size_t)end);
+	return 1;
+}
+
+int str_utolist(struct YASL_State *S) {
+	struct YASL_String *str = checkstr(S, "str.utolist", 0);
+	checkutf8len(S, "str.utolist", str);
+
+	const char *chars = YASL_String_chars(str);
+	const size_t len = YASL_String_len(str);
+	YASL_pushlist(S);
+	for (size_t i = 0; i < len;) {
+		const size_t n = utf8_seq_len((unsigned char)chars[i]);
+		if (n == 1) {
+			vm_pushchar((struct VM *)S, chars[i]);
+		} else {
+			YASL_pushlstr(S, chars + i, n);
+		}
+		YASL_listpush(S);
+		i += n;
+	}
+	return 1;
+}
+
+int str_splititer(struct YASL_State *S) {
+	struct YASL_String *str = checkstr(S, "str.splititer", 0);
+
+	if (YASL_isnundef(S, 1)) {
+		str_iter_push(S, str, NULL, STR_ITER_SPLIT_SPACE);
+		return 1;
+	}
+
+	struct YASL_String *sep = checkstr(S, "str.splititer", 1);
+	if (YASL_String_len(sep) == 0) {
+		YASLX_print_and_throw_err_value(S, "str.splititer expected a non-empty str as arg 1.");
+	}
+
+	str_iter_push(S, str, sep, STR_ITER_SPLIT);
+	return 1;
+}
+
+int str_lines(struct YASL_State *S) {
+	struct YASL_String *str = checkstr(S, "str.lines", 0);
+	str_iter_push(S, str, NULL, STR_ITER_LINES);
+	return 1;
+}
+
+int str_bytes(struct YASL_State *S) {
+	struct YASL_String *str = checkstr(S, "str.bytes", 0);
+	str_iter_push(S, str, NULL, STR_ITER_BYTES);
+	return 1;
+}
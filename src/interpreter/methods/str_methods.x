@@ -28,4 +28,11 @@ X(trim, 2)
 X(rep, 2)
 X(has, 3)
 X(__get, 2)
-X(__iter, 1)
\ No newline at end of file
+X(__iter, 1)
+X(ulen, 1)
+X(uget, 2)
+X(uslice, 3)
+X(utolist, 1)
+X(splititer, 2)
+X(lines, 1)
+X(bytes, 1)
\ No newline at end of file
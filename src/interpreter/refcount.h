@@ -10,8 +10,10 @@ struct YASL_Object;
 struct RC {
 	size_t refs;
 	bool is_condemned;
+	bool is_interned;  // only used by strings
+	bool is_borrowed;  // only used by strings: the chars are not a separate allocation owned by the string
 };
 
-#define NEW_RC() ((struct RC) { 0, false })
+#define NEW_RC() ((struct RC) { 0, false, false, false })
 
 #endif
@@ -19,17 +19,17 @@
 
 extern int random_offset;
 
-// -b: run bytecode
-// -c: compile to bytecode
 static int main_help(int argc, char **argv) {
 	YASL_UNUSED(argc);
 	YASL_UNUSED(argv);
 	puts("usage: yasl [option] [input]\n"
 	     "options:\n"
+	     "\t-b input [output]: compiles `input` to the bytecode file `output` (by default, `input` followed by `c`).\n"
 	     "\t-C: checks `input` for syntax errors but doesn't run it.\n"
 	     "\t-e input: executes `input` as code and prints result of last statement.\n"
 	     "\t-E input: executes `input` as code.\n"
 	     "\t-h: show this text.\n"
+	     "\t-r input: runs the bytecode file `input`, as written by -b.\n"
 	     "\t-V: print current version.\n"
 	     "\tinput: name of file containing script (or literal to execute with -e or -E)."
 	);
@@ -151,14 +151,53 @@ static int main_gen_bytecode(int argc, char **argv) {
 	YASLX_decllibs(S);
 
 	YASL_declglobal(S, "args");
-	int status = YASL_compile(S);
+
+	char *output;
+	if (argc > 3) {
+		output = argv[3];
+	} else {
+		const size_t len = strlen(argv[2]);
+		output = (char *)malloc(len + 2);
+		memcpy(output, argv[2], len);
+		output[len] = 'c';
+		output[len + 1] = '\0';
+	}
+
+	int status = YASL_savebytecode(S, output);
+	if (status == YASL_ERROR) {
+		fprintf(stderr, "Error: cannot write file (%s).\n", output);
+	}
+
+	if (argc <= 3) {
+		free(output);
+	}
+	YASL_delstate(S);
+
+	return status;
+}
+
+YASL_WARN_UNUSED
+static int main_run_bytecode(int argc, char **argv) {
+	struct YASL_State *S = YASL_newstate_bytecode(argv[2]);
+
+	if (!S) {
+		fprintf(stderr, "Error: cannot load bytecode file (%s).\n", argv[2]);
+		return YASL_ERROR;
+	}
+
+	// Load Standard Libraries
+	YASLX_decllibs(S);
+
+	YASL_declglobal(S, "args");
 	YASL_pushlist(S);
-	for (int i = 1; i < argc; i++) {
+	for (int i = 2; i < argc; i++) {
 		YASL_pushlit(S, argv[i]);
 		YASL_listpush(S);
 	}
 	YASL_setglobal(S, "args");
 
+	int status = YASL_execute(S);
+
 	YASL_delstate(S);
 
 	return status;
@@ -261,8 +300,10 @@ int main(int argc, char **argv) {
 		return main_command(argc, argv);
 	} else if (argc == 3 && !strcmp(argv[1], "-C")) {
 		return main_compile(argc, argv);
-	} else if (argc == 3 && !strcmp(argv[1], "-b")) {
+	} else if ((argc == 3 || argc == 4) && !strcmp(argv[1], "-b")) {
 		return main_gen_bytecode(argc, argv);
+	} else if (argc >= 3 && !strcmp(argv[1], "-r")) {
+		return main_run_bytecode(argc, argv);
 	} else {
 		return main_file(argc, argv);
 	}
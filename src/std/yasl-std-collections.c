@@ -1,13 +1,19 @@
 #include "yasl-std-collections.h"
 
+#include "data-structures/YASL_ByteBuffer.h"
+#include "data-structures/YASL_Deque.h"
 #include "data-structures/YASL_Set.h"
 #include "yasl_state.h"
 #include "yasl_aux.h"
 
 // what to prepend to method names in messages to user
 #define SET_PRE "collections.set"
+#define DEQUE_PRE "collections.deque"
+#define BUILDER_PRE "collections.builder"
 
 static const char *const SET_NAME = "collections.set";
+static const char *const DEQUE_NAME = "collections.deque";
+static const char *const BUILDER_NAME = "collections.builder";
 
 static struct YASL_Set *YASLX_checknset(struct YASL_State *S, const char *name, unsigned n) {
 	return (struct YASL_Set *)YASLX_checknuserdata(S, SET_NAME, name, n);
@@ -332,6 +338,277 @@ static int YASL_collections_set_has(struct YASL_State *S) {
 	return 1;
 }
 
+static struct YASL_Deque *YASLX_checkndeque(struct YASL_State *S, const char *name, unsigned n) {
+	return (struct YASL_Deque *)YASLX_checknuserdata(S, DEQUE_NAME, name, n);
+}
+
+static void YASL_collections_pushdeque(struct YASL_State *S, struct YASL_Deque *dq) {
+	YASL_pushuserdata(S, dq, DEQUE_NAME, YASL_Deque_del);
+	YASL_loadmt(S, DEQUE_NAME);
+	YASL_setmt(S);
+}
+
+static int YASL_collections_deque_new(struct YASL_State *S) {
+	yasl_int i = YASL_peekvargscount(S);
+	struct YASL_Deque *dq = YASL_Deque_new();
+	while (i-- > 0) {
+		YASL_Deque_pushleft(dq, vm_pop((struct VM *) S));
+	}
+
+	YASL_collections_pushdeque(S, dq);
+	return 1;
+}
+
+static int YASL_collections_deque_tostr(struct YASL_State *S) {
+	struct YASL_Deque *dq = YASLX_checkndeque(S, DEQUE_PRE ".tostr", 0);
+	struct YASL_Object *format = vm_peek_p((struct VM *)S);
+
+	if (YASL_Deque_len(dq) == 0) {
+		YASL_pushlit(S, "deque()");
+		return 1;
+	}
+
+	YASL_ByteBuffer bb = NEW_BB(8);
+	YASL_ByteBuffer_extend(&bb, (const byte *)"deque(", strlen("deque("));
+
+	FOR_DEQUE(i, item, dq) {
+		if (obj_isuserdata(&item) && item.value.uval->data == dq) {
+			YASL_ByteBuffer_extend(&bb, (const byte *)"deque(...), ", strlen("deque(...), "));
+			continue;
+		}
+		vm_push((struct VM *)S, item);
+		vm_stringify_top_format((struct VM *) S, format);
+		struct YASL_String *str = vm_popstr((struct VM *) S);
+
+		YASL_ByteBuffer_extend(&bb, (const byte *)YASL_String_chars(str), YASL_String_len(str));
+		YASL_ByteBuffer_extend(&bb, (const byte *)", ", 2);
+	}
+
+	bb.count -= 2;
+	YASL_ByteBuffer_add_byte(&bb, ')');
+	vm_pushstr_bb((struct VM *)S, &bb);
+	return 1;
+}
+
+static int YASL_collections_deque_tolist(struct YASL_State *S) {
+	struct YASL_Deque *dq = YASLX_checkndeque(S, DEQUE_PRE ".tolist", 0);
+	struct RC_UserData *list = rcls_new_sized(&S->vm, YASL_Deque_len(dq) ? YASL_Deque_len(dq) : LIST_BASESIZE);
+	struct YASL_List *ls = (struct YASL_List *)list->data;
+	FOR_DEQUE(i, item, dq) {
+		YASL_List_push(ls, item);
+	}
+
+	vm_pushlist(&S->vm, list);
+	return 1;
+}
+
+static int YASL_collections_deque___len(struct YASL_State *S) {
+	struct YASL_Deque *dq = YASLX_checkndeque(S, DEQUE_PRE ".__len", 0);
+
+	YASL_pushint(S, YASL_Deque_len(dq));
+	return 1;
+}
+
+static struct YASL_Object *YASL_collections_deque_index(struct YASL_State *S, struct YASL_Deque *dq, yasl_int index) {
+	const yasl_int len = (yasl_int)YASL_Deque_len(dq);
+	if (index < -len || index >= len) {
+		YASLX_print_and_throw_err_value(S, "unable to index deque of length %" PRI_SIZET " with index %" PRId64 ".", dq->count, index);
+	}
+
+	if (index < 0) index += len;
+	return YASL_Deque_at(dq, (size_t)index);
+}
+
+static int YASL_collections_deque___get(struct YASL_State *S) {
+	struct YASL_Deque *dq = YASLX_checkndeque(S, DEQUE_PRE ".__get", 0);
+	yasl_int index = YASLX_checknint(S, DEQUE_PRE ".__get", 1);
+
+	vm_push(&S->vm, *YASL_collections_deque_index(S, dq, index));
+	return 1;
+}
+
+static int YASL_collections_deque___set(struct YASL_State *S) {
+	struct YASL_Object value = vm_pop(&S->vm);
+	struct YASL_Deque *dq = YASLX_checkndeque(S, DEQUE_PRE ".__set", 0);
+	yasl_int index = YASLX_checknint(S, DEQUE_PRE ".__set", 1);
+
+	struct YASL_Object *slot = YASL_collections_deque_index(S, dq, index);
+	inc_ref(&value);
+	vm_dec_ref(&S->vm, slot);
+	*slot = value;
+	return 0;
+}
+
+static int YASL_collections_deque_push(struct YASL_State *S) {
+	struct YASL_Object val = vm_pop(&S->vm);
+	struct YASL_Deque *dq = YASLX_checkndeque(S, DEQUE_PRE ".push", 0);
+
+	YASL_Deque_push(dq, val);
+	return 1;
+}
+
+static int YASL_collections_deque_pushleft(struct YASL_State *S) {
+	struct YASL_Object val = vm_pop(&S->vm);
+	struct YASL_Deque *dq = YASLX_checkndeque(S, DEQUE_PRE ".pushleft", 0);
+
+	YASL_Deque_pushleft(dq, val);
+	return 1;
+}
+
+#define YASL_COLLECTIONS_DEQUE_POP(name) \
+static int YASL_collections_deque_##name(struct YASL_State *S) {\
+	struct YASL_Deque *dq = YASLX_checkndeque(S, DEQUE_PRE "." #name, 0);\
+	if (YASL_Deque_len(dq) == 0) {\
+		YASLX_print_and_throw_err_value(S, "%s expected nonempty deque as arg 0.", DEQUE_PRE "." #name);\
+	}\
+\
+	struct YASL_Object val = YASL_Deque_##name(dq);\
+	vm_push(&S->vm, val);\
+	vm_dec_ref(&S->vm, &val);\
+	return 1;\
+}
+
+YASL_COLLECTIONS_DEQUE_POP(pop)
+YASL_COLLECTIONS_DEQUE_POP(popleft)
+
+static int YASL_collections_deque_copy(struct YASL_State *S) {
+	struct YASL_Deque *dq = YASLX_checkndeque(S, DEQUE_PRE ".copy", 0);
+
+	struct YASL_Deque *tmp = YASL_Deque_new();
+	FOR_DEQUE(i, item, dq) {
+		YASL_Deque_push(tmp, item);
+	}
+
+	YASL_collections_pushdeque(S, tmp);
+	return 1;
+}
+
+static int YASL_collections_deque_clear(struct YASL_State *S) {
+	struct YASL_Deque *dq = YASLX_checkndeque(S, DEQUE_PRE ".clear", 0);
+
+	YASL_Deque_clear(&S->vm, dq);
+	return 1;
+}
+
+static int YASL_collections_deque_next(struct YASL_State *S) {
+	struct YASL_Deque *dq = YASLX_checkndeque(S, DEQUE_PRE ".__next", 0);
+	yasl_int curr = YASLX_checknint(S, DEQUE_PRE ".__next", 1);
+
+	if (curr < 0 || curr >= (yasl_int)YASL_Deque_len(dq)) {
+		YASL_pushbool(S, false);
+		return 1;
+	}
+
+	YASL_pushint(S, curr + 1);
+	vm_push(&S->vm, *YASL_Deque_at(dq, (size_t)curr));
+	YASL_pushbool(S, true);
+	return 3;
+}
+
+static int YASL_collections_deque___iter(struct YASL_State *S) {
+	YASLX_checkndeque(S, DEQUE_PRE ".__iter", 0);
+	YASL_pushcfunction(S, YASL_collections_deque_next, 2);
+	YASL_pushint(S, 0);
+	return 2;
+}
+
+static YASL_ByteBuffer *YASLX_checknbuilder(struct YASL_State *S, const char *name, unsigned n) {
+	return (YASL_ByteBuffer *)YASLX_checknuserdata(S, BUILDER_NAME, name, n);
+}
+
+static void YASL_collections_builder_del(struct YASL_State *S, void *bb) {
+	YASL_UNUSED(S);
+	YASL_ByteBuffer_del((YASL_ByteBuffer *)bb);
+}
+
+/*
+ * Pops the top of the stack, stringifying it first if needed, and appends it to bb.
+ */
+static void YASL_collections_builder_extend_top(struct YASL_State *S, YASL_ByteBuffer *bb, struct YASL_Object *format) {
+	if (format || !vm_isstr(&S->vm)) {
+		vm_stringify_top_format(&S->vm, format);
+	}
+	struct YASL_String *str = vm_popstr(&S->vm);
+	if (YASL_String_len(str) > 0) {
+		YASL_ByteBuffer_extend(bb, (const byte *)YASL_String_chars(str), YASL_String_len(str));
+	}
+}
+
+static int YASL_collections_builder_new(struct YASL_State *S) {
+	yasl_int i = YASL_peekvargscount(S);
+	yasl_int start = YASL_getvargsstart(S);
+	YASL_ByteBuffer *bb = YASL_ByteBuffer_new(16);
+
+	YASL_pushuserdata(S, bb, BUILDER_NAME, YASL_collections_builder_del);
+	YASL_loadmt(S, BUILDER_NAME);
+	YASL_setmt(S);
+
+	for (yasl_int j = start; j < start + i; j++) {
+		vm_push(&S->vm, vm_peek(&S->vm, S->vm.fp + 1 + j));
+		YASL_collections_builder_extend_top(S, bb, NULL);
+	}
+
+	return 1;
+}
+
+static int YASL_collections_builder_tostr(struct YASL_State *S) {
+	YASL_ByteBuffer *bb = YASLX_checknbuilder(S, BUILDER_PRE ".tostr", 0);
+	struct YASL_Object *format = vm_peek_p((struct VM *)S);
+
+	YASL_pushlstr(S, bb->count ? (const char *)bb->items : "", bb->count);
+	if (!obj_isundef(format)) {
+		vm_stringify_top_format((struct VM *)S, format);
+	}
+	return 1;
+}
+
+static int YASL_collections_builder_build(struct YASL_State *S) {
+	YASL_ByteBuffer *bb = YASLX_checknbuilder(S, BUILDER_PRE ".build", 0);
+
+	if (bb->count == 0) {
+		YASL_pushlit(S, "");
+		return 1;
+	}
+
+	// Hand the buffer over to the new str and start the builder again from empty.
+	char *chars = (char *)realloc(bb->items, bb->count);
+	const size_t len = bb->count;
+	bb->items = NULL;
+	bb->size = 0;
+	bb->count = 0;
+	vm_pushstr(&S->vm, YASL_String_new_take(&S->vm, chars, len));
+	return 1;
+}
+
+static int YASL_collections_builder___len(struct YASL_State *S) {
+	YASL_ByteBuffer *bb = YASLX_checknbuilder(S, BUILDER_PRE ".__len", 0);
+
+	YASL_pushint(S, (yasl_int)bb->count);
+	return 1;
+}
+
+static int YASL_collections_builder_append(struct YASL_State *S) {
+	YASL_ByteBuffer *bb = YASLX_checknbuilder(S, BUILDER_PRE ".append", 0);
+
+	YASL_collections_builder_extend_top(S, bb, NULL);
+	return 1;
+}
+
+static int YASL_collections_builder_appendf(struct YASL_State *S) {
+	YASL_ByteBuffer *bb = YASLX_checknbuilder(S, BUILDER_PRE ".appendf", 0);
+
+	struct YASL_Object format = vm_pop(&S->vm);
+	YASL_collections_builder_extend_top(S, bb, &format);
+	return 1;
+}
+
+static int YASL_collections_builder_clear(struct YASL_State *S) {
+	YASL_ByteBuffer *bb = YASLX_checknbuilder(S, BUILDER_PRE ".clear", 0);
+
+	bb->count = 0;
+	return 1;
+}
+
 int YASL_decllib_collections(struct YASL_State *S) {
 	YASL_pushtable(S);
 	YASL_registermt(S, SET_NAME);
@@ -363,6 +640,46 @@ int YASL_decllib_collections(struct YASL_State *S) {
 	YASLX_tablesetfunctions(S, functions);
 	YASL_pop(S);
 
+	YASL_pushtable(S);
+	YASL_registermt(S, DEQUE_NAME);
+
+	struct YASLX_function deque_functions[] = {
+		{ "tostr", &YASL_collections_deque_tostr, 2 },
+		{ "tolist", &YASL_collections_deque_tolist, 1 },
+		{ "__len", &YASL_collections_deque___len, 1 },
+		{ "__get", &YASL_collections_deque___get, 2 },
+		{ "__set", &YASL_collections_deque___set, 3 },
+		{ "__iter", &YASL_collections_deque___iter, 1 },
+		{ "push", &YASL_collections_deque_push, 2 },
+		{ "pushleft", &YASL_collections_deque_pushleft, 2 },
+		{ "pop", &YASL_collections_deque_pop, 1 },
+		{ "popleft", &YASL_collections_deque_popleft, 1 },
+		{ "copy", &YASL_collections_deque_copy, 1 },
+		{ "clear", &YASL_collections_deque_clear, 1 },
+		{ NULL, NULL, 0 }
+	};
+
+	YASL_loadmt(S, DEQUE_NAME);
+	YASLX_tablesetfunctions(S, deque_functions);
+	YASL_pop(S);
+
+	YASL_pushtable(S);
+	YASL_registermt(S, BUILDER_NAME);
+
+	struct YASLX_function builder_functions[] = {
+		{ "tostr", &YASL_collections_builder_tostr, 2 },
+		{ "build", &YASL_collections_builder_build, 1 },
+		{ "__len", &YASL_collections_builder___len, 1 },
+		{ "append", &YASL_collections_builder_append, 2 },
+		{ "appendf", &YASL_collections_builder_appendf, 3 },
+		{ "clear", &YASL_collections_builder_clear, 1 },
+		{ NULL, NULL, 0 }
+	};
+
+	YASL_loadmt(S, BUILDER_NAME);
+	YASLX_tablesetfunctions(S, builder_functions);
+	YASL_pop(S);
+
 	YASL_pushtable(S);
 	YASLX_initglobal(S, "collections");
 
@@ -371,7 +688,9 @@ int YASL_decllib_collections(struct YASL_State *S) {
 	struct YASLX_function constructors[] = {
 		{ "set", &YASL_collections_set_new, -1 },
 		{ "list", &YASL_collections_list_new, -1 },
+		{ "deque", &YASL_collections_deque_new, -1 },
 		{ "table", &YASL_collections_table_new, -1 },
+		{ "builder", &YASL_collections_builder_new, -1 },
 		{ NULL, NULL, 0}
 	};
 
@@ -0,0 +1,279 @@
+#include "yasl-std-re.h"
+
+#include "data-structures/YASL_ByteBuffer.h"
+#include "util/yasl_regex.h"
+#include "yasl_aux.h"
+#include "yasl_state.h"
+
+// what to prepend to method names in messages to user
+#define PATTERN_PRE "re.pattern"
+
+static const char *const PATTERN_NAME = "re.pattern";
+
+static struct YASL_Regex *YASLX_checknpattern(struct YASL_State *S, const char *name, unsigned n) {
+	return (struct YASL_Regex *)YASLX_checknuserdata(S, PATTERN_NAME, name, n);
+}
+
+static struct YASL_String *YASLX_checknyaslstr(struct YASL_State *S, const char *name, unsigned n) {
+	if (!YASL_isnstr(S, n)) {
+		YASLX_print_and_throw_err_bad_arg_type_n(S, name, n, YASL_STR_NAME);
+	}
+
+	return vm_peekstr(&S->vm, S->vm.fp + 1 + n);
+}
+
+static yasl_int YASLX_checknstart(struct YASL_State *S, const char *name, unsigned n, struct YASL_String *str) {
+	const yasl_int len = (yasl_int)YASL_String_len(str);
+	yasl_int start = YASLX_checknoptint(S, name, n, 0);
+	if (start < 0) start += len;
+	if (start < 0 || start > len) {
+		YASLX_print_and_throw_err_value(S, "%s expected a start index in range of str of length %" PRId64 ", got %" PRId64 ".",
+						name, len, YASLX_checknoptint(S, name, n, 0));
+	}
+	return start;
+}
+
+static void YASL_re_pattern_del(struct YASL_State *S, void *re) {
+	YASL_UNUSED(S);
+	regex_del((struct YASL_Regex *)re);
+}
+
+/*
+ * Pushes str[start:end]. The whole str is pushed as is, rather than copied.
+ */
+static void YASL_re_pushsubstring(struct YASL_State *S, struct YASL_String *str, size_t start, size_t end) {
+	if (start == REGEX_NO_MATCH) {
+		YASL_pushundef(S);
+	} else if (start == 0 && end == YASL_String_len(str)) {
+		vm_pushstr(&S->vm, str);
+	} else {
+		vm_pushstr(&S->vm, YASL_String_new_substring(&S->vm, str, start, end));
+	}
+}
+
+static void YASL_re_pushgroups(struct YASL_State *S, struct YASL_Regex *re, struct YASL_String *str, const size_t *caps) {
+	YASL_pushlist(S);
+	for (size_t i = 0; i < regex_num_groups(re); i++) {
+		YASL_re_pushsubstring(S, str, caps[2 * i], caps[2 * i + 1]);
+		YASL_listpush(S);
+	}
+}
+
+/*
+ * Finds the next match at or after *pos, then moves *pos to its end. As in Perl, an empty match right where the
+ * previous match ended is skipped, so that each position yields at most one match. *prev_end should start out as
+ * REGEX_NO_MATCH.
+ */
+static bool YASL_re_next(struct YASL_Regex *re, const char *chars, const size_t len, size_t *pos, size_t *prev_end,
+			 size_t *caps) {
+	while (*pos <= len && regex_exec(re, chars, len, *pos, false, caps)) {
+		if (caps[0] == caps[1] && caps[0] == *prev_end) {
+			*pos = caps[0] + 1;
+			continue;
+		}
+		*pos = *prev_end = caps[1];
+		return true;
+	}
+	return false;
+}
+
+static int YASL_re_compile(struct YASL_State *S) {
+	size_t len;
+	const char *pattern = YASLX_checknstr(S, "re.compile", 0, &len);
+
+	const char *error;
+	size_t error_pos;
+	struct YASL_Regex *re = regex_compile(pattern, len, &error, &error_pos);
+	if (!re) {
+		YASLX_print_and_throw_err_value(S, "re.compile: %s at position %" PRI_SIZET ".", error, error_pos);
+	}
+
+	YASL_pushuserdata(S, re, PATTERN_NAME, YASL_re_pattern_del);
+	YASL_loadmt(S, PATTERN_NAME);
+	YASL_setmt(S);
+	return 1;
+}
+
+#define YASL_RE_PATTERN_EXEC(name, anchored) \
+static int YASL_re_pattern_##name(struct YASL_State *S) {\
+	struct YASL_Regex *re = YASLX_checknpattern(S, PATTERN_PRE "." #name, 0);\
+	struct YASL_String *str = YASLX_checknyaslstr(S, PATTERN_PRE "." #name, 1);\
+	const yasl_int start = YASLX_checknstart(S, PATTERN_PRE "." #name, 2, str);\
+\
+	size_t *caps = (size_t *)malloc(2 * regex_num_groups(re) * sizeof(size_t));\
+	if (regex_exec(re, YASL_String_chars(str), YASL_String_len(str), (size_t)start, anchored, caps)) {\
+		YASL_re_pushgroups(S, re, str, caps);\
+	} else {\
+		YASL_pushundef(S);\
+	}\
+	free(caps);\
+	return 1;\
+}
+
+YASL_RE_PATTERN_EXEC(match, true)
+YASL_RE_PATTERN_EXEC(find, false)
+
+static int YASL_re_pattern_findall(struct YASL_State *S) {
+	struct YASL_Regex *re = YASLX_checknpattern(S, PATTERN_PRE ".findall", 0);
+	struct YASL_String *str = YASLX_checknyaslstr(S, PATTERN_PRE ".findall", 1);
+	const char *chars = YASL_String_chars(str);
+	const size_t len = YASL_String_len(str);
+	const size_t num_groups = regex_num_groups(re);
+
+	size_t *caps = (size_t *)malloc(2 * num_groups * sizeof(size_t));
+	YASL_pushlist(S);
+	size_t pos = 0;
+	size_t prev_end = REGEX_NO_MATCH;
+	while (YASL_re_next(re, chars, len, &pos, &prev_end, caps)) {
+		// Like Python: the whole match if there are no groups, the only group if there is one, else all groups.
+		if (num_groups <= 2) {
+			const size_t group = num_groups - 1;
+			YASL_re_pushsubstring(S, str, caps[2 * group], caps[2 * group + 1]);
+		} else {
+			YASL_pushlist(S);
+			for (size_t i = 1; i < num_groups; i++) {
+				YASL_re_pushsubstring(S, str, caps[2 * i], caps[2 * i + 1]);
+				YASL_listpush(S);
+			}
+		}
+		YASL_listpush(S);
+	}
+	free(caps);
+	return 1;
+}
+
+static int YASL_re_pattern_split(struct YASL_State *S) {
+	struct YASL_Regex *re = YASLX_checknpattern(S, PATTERN_PRE ".split", 0);
+	struct YASL_String *str = YASLX_checknyaslstr(S, PATTERN_PRE ".split", 1);
+	yasl_int max_splits = YASLX_checknoptint(S, PATTERN_PRE ".split", 2, -1);
+	const char *chars = YASL_String_chars(str);
+	const size_t len = YASL_String_len(str);
+
+	size_t *caps = (size_t *)malloc(2 * regex_num_groups(re) * sizeof(size_t));
+	YASL_pushlist(S);
+	size_t piece = 0;
+	size_t pos = 0;
+	size_t prev_end = REGEX_NO_MATCH;
+	while (max_splits != 0 && YASL_re_next(re, chars, len, &pos, &prev_end, caps)) {
+		// Empty matches only split between bytes, never at either end.
+		if (caps[1] == caps[0] && (caps[0] == 0 || caps[0] == len)) {
+			continue;
+		}
+		YASL_re_pushsubstring(S, str, piece, caps[0]);
+		YASL_listpush(S);
+		piece = caps[1];
+		if (max_splits > 0) max_splits--;
+	}
+	YASL_re_pushsubstring(S, str, piece, len);
+	YASL_listpush(S);
+	free(caps);
+	return 1;
+}
+
+/*
+ * Appends repl to bb, replacing $0 to $9 with the matching group and $$ with $.
+ */
+static void YASL_re_expand(YASL_ByteBuffer *bb, const char *repl, const size_t repl_len, const char *chars,
+			   const size_t *caps, const size_t num_groups) {
+	size_t i = 0;
+	while (i < repl_len) {
+		size_t j = i;
+		while (j < repl_len && repl[j] != '$') {
+			j++;
+		}
+		if (j > i) {
+			YASL_ByteBuffer_extend(bb, (const byte *)repl + i, j - i);
+		}
+		if (j + 1 >= repl_len) {
+			if (j < repl_len) YASL_ByteBuffer_add_byte(bb, '$');
+			return;
+		}
+
+		const char c = repl[j + 1];
+		if (c == '$') {
+			YASL_ByteBuffer_add_byte(bb, '$');
+		} else if ('0' <= c && c <= '9' && (size_t)(c - '0') < num_groups) {
+			const size_t group = (size_t)(c - '0');
+			if (caps[2 * group] != REGEX_NO_MATCH && caps[2 * group + 1] > caps[2 * group]) {
+				YASL_ByteBuffer_extend(bb, (const byte *)chars + caps[2 * group], caps[2 * group + 1] - caps[2 * group]);
+			}
+		} else {
+			YASL_ByteBuffer_add_byte(bb, '$');
+			YASL_ByteBuffer_add_byte(bb, (byte)c);
+		}
+		i = j + 2;
+	}
+}
+
+static int YASL_re_pattern_replace(struct YASL_State *S) {
+	struct YASL_Regex *re = YASLX_checknpattern(S, PATTERN_PRE ".replace", 0);
+	struct YASL_String *str = YASLX_checknyaslstr(S, PATTERN_PRE ".replace", 1);
+	size_t repl_len;
+	const char *repl = YASLX_checknstr(S, PATTERN_PRE ".replace", 2, &repl_len);
+	yasl_int max = YASLX_checknoptint(S, PATTERN_PRE ".replace", 3, -1);
+	const char *chars = YASL_String_chars(str);
+	const size_t len = YASL_String_len(str);
+	const size_t num_groups = regex_num_groups(re);
+
+	size_t *caps = (size_t *)malloc(2 * num_groups * sizeof(size_t));
+	YASL_ByteBuffer bb = NEW_BB(len + 1);
+	size_t copied = 0;
+	size_t pos = 0;
+	size_t prev_end = REGEX_NO_MATCH;
+	bool replaced = false;
+	while (max != 0 && YASL_re_next(re, chars, len, &pos, &prev_end, caps)) {
+		if (caps[0] > copied) {
+			YASL_ByteBuffer_extend(&bb, (const byte *)chars + copied, caps[0] - copied);
+		}
+		YASL_re_expand(&bb, repl, repl_len, chars, caps, num_groups);
+		copied = caps[1];
+		replaced = true;
+		if (max > 0) max--;
+	}
+	free(caps);
+
+	if (!replaced) {
+		free(bb.items);
+		vm_pushstr(&S->vm, str);
+		return 1;
+	}
+
+	if (len > copied) {
+		YASL_ByteBuffer_extend(&bb, (const byte *)chars + copied, len - copied);
+	}
+	vm_pushstr_bb(&S->vm, &bb);
+	return 1;
+}
+
+int YASL_decllib_re(struct YASL_State *S) {
+	YASL_pushtable(S);
+	YASL_registermt(S, PATTERN_NAME);
+
+	struct YASLX_function pattern_functions[] = {
+		{ "match", &YASL_re_pattern_match, 3 },
+		{ "find", &YASL_re_pattern_find, 3 },
+		{ "findall", &YASL_re_pattern_findall, 2 },
+		{ "split", &YASL_re_pattern_split, 3 },
+		{ "replace", &YASL_re_pattern_replace, 4 },
+		{ NULL, NULL, 0 }
+	};
+
+	YASL_loadmt(S, PATTERN_NAME);
+	YASLX_tablesetfunctions(S, pattern_functions);
+	YASL_pop(S);
+
+	YASL_pushtable(S);
+	YASLX_initglobal(S, "re");
+
+	YASL_loadglobal(S, "re");
+
+	struct YASLX_function functions[] = {
+		{ "compile", &YASL_re_compile, 1 },
+		{ NULL, NULL, 0 }
+	};
+
+	YASLX_tablesetfunctions(S, functions);
+	YASL_pop(S);
+
+	return YASL_SUCCESS;
+}
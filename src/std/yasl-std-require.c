@@ -4,12 +4,34 @@
 
 #define LOAD_LIB_FUN_NAME "YASL_load_dyn_lib"
 
-struct YASL_State *YASL_newstate_num(const char *filename, size_t num);
 struct YASL_State *YASL_newstate_bb_num(const char *buffer, size_t len, size_t num);
+int YASL_execute_cached(struct YASL_State *S, const char *cache_filename, const uint64_t source_hash);
+int YASL_execute_fn(struct YASL_State *S);
+void vm_init_buf(struct VM *vm);
+void vm_deinit_buf(struct VM *vm);
+void vm_CALL_now(struct VM *const vm);
+void vm_exitframe_multi(struct VM *const vm, int len);
+void vm_printline(struct VM *vm, int fp);
+
+#if defined(YASL_USE_WIN)
+#include <direct.h>
+#define MAKE_DIR(path) _mkdir(path)
+#define RESOLVE_PATH(path) _fullpath(NULL, path, 0)
+#elif defined(YASL_USE_UNIX) || defined(YASL_USE_APPLE)
+#include <sys/stat.h>
+#define MAKE_DIR(path) mkdir(path, 0777)
+#define RESOLVE_PATH(path) realpath(path, NULL)
+#else
+#define MAKE_DIR(path) (-1)
+#define RESOLVE_PATH(path) NULL
+#endif
 
 // TODO: rewrite this whole fucking mess. I'm not even sure if it works properly honestly.
 
-static struct YASL_State *open_on_path(const char *path, const char *name, const char sep, const char dirmark, const size_t num) {
+/*
+ * Opens the first file found by substituting name into path, and sets filename to its name, which the caller frees.
+ */
+static FILE *open_on_path(const char *path, const char *name, const char sep, const char dirmark, char **filename) {
 	const char *start = path;
 	const char *end = strchr(start, dirmark);
 	while (end != NULL) {
@@ -20,19 +42,84 @@ static struct YASL_State *open_on_path(const char *path, const char *name, const
 		memcpy(buffer + (split - start) + strlen(name), split + 1, end - split - 1);
 		buffer[end - start + strlen(name) - 1] = '\0';
 
-		struct YASL_State *S = YASL_newstate_num(buffer, num);
+		FILE *fp = fopen(buffer, "rb");
+		if (fp) {
+			*filename = buffer;
+			return fp;
+		}
 		free(buffer);
-		if (S)
-			return S;
 
 		start = end + 1;
 		end = strchr(start, dirmark);
 	}
 
-	return YASL_newstate_num(name, num);
+	FILE *fp = fopen(name, "rb");
+	if (fp) {
+		*filename = (char *)malloc(strlen(name) + 1);
+		strcpy(*filename, name);
+	}
+	return fp;
+}
+
+static char *read_file(FILE *fp, size_t *len) {
+	if (fseek(fp, 0, SEEK_END)) return NULL;
+	const long size = ftell(fp);
+	if (size < 0 || fseek(fp, 0, SEEK_SET)) return NULL;
+	char *buffer = (char *)malloc((size_t)size + 1);
+	*len = fread(buffer, 1, (size_t)size, fp);
+	return buffer;
+}
+
+static uint64_t hash_bytes(const unsigned char *bytes, const size_t len) {
+	// FNV-1a. 0 is reserved for bytecode that isn't a cached module.
+	uint64_t hash = UINT64_C(14695981039346656037);
+	for (size_t i = 0; i < len; i++) {
+		hash ^= bytes[i];
+		hash *= UINT64_C(1099511628211);
+	}
+	return hash ? hash : 1;
+}
+
+/*
+ * Returns the name of the file in which the bytecode for the module in filename is cached, creating its directory if
+ * needed, or NULL if the cache is disabled. Modules share the constants of whatever requires them, so bytecode is only
+ * valid after the same constants; the name includes a hash of S's constants, so that each set of them gets its own file.
+ */
+static char *cache_filename(struct YASL_State *S, const char *filename) {
+#ifdef YASL_MODULE_CACHE_DIR
+	const char *base = filename;
+	for (const char *curr = filename; *curr; curr++) {
+		if (*curr == '/' || *curr == '\\') base = curr + 1;
+	}
+	const char *ext = strrchr(base, '.');
+	if (!ext || ext == base) ext = base + strlen(base);
+	const size_t dir_len = base - filename;
+	const size_t cache_dir_len = strlen(YASL_MODULE_CACHE_DIR);
+	const YASL_ByteBuffer *constants = S->compiler.header;
+	const uint64_t hash = hash_bytes(constants->items + 3 * sizeof(int64_t), constants->count - 3 * sizeof(int64_t));
+
+	// <dir>/<cache dir>/<name>.<hash><ext>c, such as lib/__yaslcache__/module.0123456789abcdef.yaslc
+	char *cached = (char *)malloc(dir_len + cache_dir_len + 1 + strlen(base) + 1 + 16 + 2);
+	memcpy(cached, filename, dir_len);
+	strcpy(cached + dir_len, YASL_MODULE_CACHE_DIR);
+	MAKE_DIR(cached);
+	char *curr = cached + dir_len + cache_dir_len;
+	*curr++ = '/';
+	memcpy(curr, base, ext - base);
+	curr += ext - base;
+	sprintf(curr, ".%016" PRIx64 "%sc", hash, ext);
+	return cached;
+#else
+	(void) S;
+	(void) filename;
+	return NULL;
+#endif
 }
 
-static int YASL_require_helper(struct YASL_State *S, struct YASL_State *Ss) {
+/*
+ * Sets up Ss, which will run a module for S, to share S's constants, globals and caches.
+ */
+static void require_prepare(struct YASL_State *S, struct YASL_State *Ss) {
 	YASL_Table_del(Ss->compiler.strings);
 	Ss->compiler.strings = S->compiler.strings;
 	YASL_ByteBuffer_del(Ss->compiler.header);
@@ -48,15 +135,25 @@ static int YASL_require_helper(struct YASL_State *S, struct YASL_State *Ss) {
 
 	YASL_Table_del(Ss->vm.metatables);
 	Ss->vm.metatables = S->vm.metatables;
+	YASL_Table_del(Ss->vm.modules);
+	Ss->vm.modules = S->vm.modules;
+	YASL_Table_del(Ss->vm.evals);
+	Ss->vm.evals = S->vm.evals;
+}
 
-	int status = YASL_execute(Ss);
-
+/*
+ * Hands the code and constants of Ss over to S, and pushes what Ss exported, once it has finished running with the
+ * given status. Deletes Ss. If Ss failed, throws its error from S instead, after the same clean up, since whatever it
+ * ran before failing may still refer to its code.
+ */
+static void require_finish(struct YASL_State *S, struct YASL_State *Ss, int status) {
 	if (status == YASL_SUCCESS) status = YASL_ERROR;
+	char *err = NULL;
 	if (status != YASL_MODULE_SUCCESS) {
 		YASL_loadprinterr(Ss);
-		const char *e = YASL_peekcstr(Ss);
-		YASL_print_err(S, "Error while loading module: %s", e);
-		YASL_throw_err(S, status);
+		err = YASL_peekcstr(Ss);
+		YASL_pop(Ss);
+		YASL_pushundef(Ss);
 	}
 
 	inc_ref(&vm_peek(&Ss->vm));
@@ -64,36 +161,46 @@ static int YASL_require_helper(struct YASL_State *S, struct YASL_State *Ss) {
 
 	YASL_pushundef(Ss);
 
-	size_t old_headers_size = S->vm.headers_size;
-	size_t new_headers_size = Ss->vm.headers_size;
-	S->vm.headers = (unsigned char **) realloc(S->vm.headers, new_headers_size * sizeof(unsigned char *));
-	for (size_t i = old_headers_size; i < new_headers_size; i++) {
-		S->vm.headers[i] = Ss->vm.headers[i];
-		Ss->vm.headers[i] = NULL;
+	// Ss only has code and constants of its own if it compiled, and so started running.
+	if (Ss->vm.code) {
+		size_t old_headers_size = S->vm.headers_size;
+		size_t new_headers_size = Ss->vm.headers_size;
+		S->vm.headers = (unsigned char **) realloc(S->vm.headers, new_headers_size * sizeof(unsigned char *));
+		for (size_t i = old_headers_size; i < new_headers_size; i++) {
+			S->vm.headers[i] = Ss->vm.headers[i];
+			Ss->vm.headers[i] = NULL;
+		}
+		S->vm.headers_size = new_headers_size;
+
+		for (int i = 0; i < S->vm.num_constants; i++) {
+			vm_dec_ref(&S->vm, S->vm.constants + i);
+		}
+		free(S->vm.constants);
+		S->vm.constants = Ss->vm.constants;
+		S->vm.num_constants = Ss->vm.num_constants;
+		Ss->vm.constants = NULL;
+		Ss->vm.num_constants = 0;
 	}
-	S->vm.headers_size = new_headers_size;
 
 	Ss->vm.globals = NULL;
 	Ss->vm.metatables = NULL;
+	Ss->vm.modules = NULL;
+	Ss->vm.evals = NULL;
 
 	Ss->vm.code = NULL;
 	Ss->compiler.strings = NULL;
 	Ss->compiler.header = YASL_ByteBuffer_new(0);
-	for (int i = 0; i < S->vm.num_constants; i++) {
-		vm_dec_ref(&S->vm, S->vm.constants + i);
-	}
-	free(S->vm.constants);
-	S->vm.constants = Ss->vm.constants;
-	S->vm.num_constants = Ss->vm.num_constants;
-	Ss->vm.constants = NULL;
-	Ss->vm.num_constants = 0;
 
 	YASL_delstate(Ss);
 
+	if (err) {
+		YASL_print_err(S, "Error while loading module: %s", err);
+		free(err);
+		YASL_throw_err(S, status);
+	}
+
 	vm_push(&S->vm, exported);
 	vm_dec_ref(&S->vm, &vm_peek(&S->vm));
-
-	return 1;
 }
 
 int YASL_require(struct YASL_State *S) {
@@ -103,9 +210,10 @@ int YASL_require(struct YASL_State *S) {
 
 	char *mode_str = YASL_peekcstr(S);
 
-	struct YASL_State *Ss = open_on_path(YASL_DEFAULT_PATH, mode_str, YASL_PATH_MARK, YASL_PATH_SEP, S->vm.headers_size);
+	char *filename;
+	FILE *fp = open_on_path(YASL_DEFAULT_PATH, mode_str, YASL_PATH_MARK, YASL_PATH_SEP, &filename);
 
-	if (!Ss) {
+	if (!fp) {
 		YASL_print_err(S, "could not open package %s.", mode_str);
 		free(mode_str);
 		YASL_throw_err(S, YASL_ERROR);
@@ -113,15 +221,119 @@ int YASL_require(struct YASL_State *S) {
 
 	free(mode_str);
 
-	return YASL_require_helper(S, Ss);
+	// Modules are run once; requiring one again gives the same exports.
+	char *resolved = RESOLVE_PATH(filename);
+	const char *key = resolved ? resolved : filename;
+	struct YASL_Object exported = YASL_Table_search_zstring(S->vm.modules, key);
+	if (exported.type != Y_END) {
+		fclose(fp);
+		free(filename);
+		free(resolved);
+		vm_push(&S->vm, exported);
+		return 1;
+	}
+
+	size_t len;
+	char *source = read_file(fp, &len);
+	fclose(fp);
+	if (!source) {
+		YASL_print_err(S, "could not read package %s.", filename);
+		free(filename);
+		free(resolved);
+		YASL_throw_err(S, YASL_ERROR);
+	}
+
+	// The key is kept on the stack rather than in filename, since loading the module may throw.
+	vm_pushstr(&S->vm, YASL_String_new_copyz_unbound(key));
+	char *cached = cache_filename(S, filename);
+	free(filename);
+	free(resolved);
+
+	struct YASL_State *Ss = YASL_newstate_bb_num(source, len, S->vm.headers_size);
+	const uint64_t hash = hash_bytes((const unsigned char *)source, len);
+	free(source);
+
+	require_prepare(S, Ss);
+	const int status = cached ? YASL_execute_cached(Ss, cached, hash) : YASL_execute(Ss);
+	free(cached);
+	require_finish(S, Ss, status);
+
+	YASL_Table_insert_fast(S->vm.modules, vm_peek(&S->vm, S->vm.sp - 1), vm_peek(&S->vm));
+
+	return 1;
+}
+
+/*
+ * Calls fn, the function compiled from some source by eval, with the same output and errors as when the source is run
+ * as a module: anything it echoes is discarded, and errors are reported as errors while loading a module.
+ */
+static int eval_call(struct YASL_State *S, struct YASL_Object fn) {
+	struct VM *vm = &S->vm;
+	jmp_buf *old_buf = vm->buf;
+	const struct IO old_out = vm->out;
+	const struct IO old_err = vm->err;
+	const int old_fp = vm->fp;
+	const int old_sp = vm->sp;
+	vm->out = NEW_IO(NULL);
+	vm->out.print = &io_print_none;
+	vm->err = NEW_IO(NULL);
+	vm->err.print = &io_print_string;
+	vm->buf = NULL;
+	vm_init_buf(vm);
+	if (setjmp(*vm->buf)) {
+		vm_deinit_buf(vm);
+		vm->buf = old_buf;
+		const int status = vm->status;
+		vm->status = YASL_SUCCESS;
+
+		vm_printline(vm, old_sp + 1);
+		while (vm->fp > old_fp) {
+			vm_exitframe_multi(vm, 0);
+		}
+
+		struct IO err = vm->err;
+		vm->out = old_out;
+		vm->err = old_err;
+		YASL_print_err(S, "Error while loading module: %.*s", (int)err.len, err.string ? err.string : "");
+		io_cleanup(&err);
+		YASL_throw_err(S, status);
+	}
+
+	vm_push(vm, fn);
+	vm_INIT_CALL_offset(vm, vm->sp, -1);
+	vm_CALL_now(vm);
+
+	vm_deinit_buf(vm);
+	vm->buf = old_buf;
+	io_cleanup(&vm->err);
+	vm->out = old_out;
+	vm->err = old_err;
+
+	if (vm->sp == old_sp) {
+		// Nothing was exported.
+		YASL_print_err(S, "Error while loading module: ");
+		YASL_throw_err(S, YASL_ERROR);
+	}
+	return 1;
 }
 
+/*
+ * Each source is compiled once, as a function that returns what it exports, and run again by calling that function.
+ */
 int YASL_eval(struct YASL_State *S) {
 	size_t len;
 	const char *buff = YASLX_checknstr(S, "eval", 0, &len);
-	struct YASL_State *Ss = YASL_newstate_bb_num(buff, len, S->vm.headers_size);
+	const struct YASL_Object source = vm_peek(&S->vm, S->vm.fp + 1);
+	struct YASL_Object fn = YASL_Table_search(S->vm.evals, source);
+	if (fn.type == Y_END) {
+		struct YASL_State *Ss = YASL_newstate_bb_num(buff, len, S->vm.headers_size);
+		require_prepare(S, Ss);
+		require_finish(S, Ss, YASL_execute_fn(Ss));
+		fn = vm_pop(&S->vm);
+		YASL_Table_insert_fast(S->vm.evals, source, fn);
+	}
 
-	return YASL_require_helper(S, Ss);
+	return eval_call(S, fn);
 }
 
 #if defined(YASL_USE_WIN)
@@ -4,16 +4,19 @@
 #include "prime.h"
 
 extern size_t random_offset;
+
+size_t hash_chars(const char *const chars, const size_t len, const size_t a, const size_t m) {
+	size_t hash = 0;
+	for (size_t i = 0; i < len; i++) {
+		hash = (hash * a) ^ chars[i];
+		hash %= m;
+	}
+	return (random_offset ^ hash) % m;
+}
+
 size_t hash_function(const struct YASL_Object s, const size_t a, const size_t m) {
 	if (obj_isstr(&s)) {
-		size_t hash = 0;
-		const int64_t len_s = YASL_String_len(s.value.sval);
-		const char *str = YASL_String_chars(s.value.sval);
-		for (int64_t i = 0; i < len_s; i++) {
-			hash = (hash * a) ^ str[i];
-			hash %= m;
-		}
-		return (random_offset ^ hash) % m;
+		return hash_chars(YASL_String_chars(s.value.sval), YASL_String_len(s.value.sval), a, m);
 	} else {
 		int64_t ll = s.value.ival & 0xFFFF;
 		int64_t lu = (s.value.ival & 0xFFFF0000) >> 16;
@@ -32,3 +35,12 @@ size_t get_hash(const struct YASL_Object s, const size_t num_buckets, const size
 	const size_t hash_b = hash_function(s, PRIME_B, num_buckets);
 	return ((size_t) (hash_a + (attempt * (hash_b + (hash_b == 0))))) % num_buckets;
 }
+
+size_t get_hash_chars(const char *const chars, const size_t len, const size_t num_buckets, const size_t attempt) {
+	const size_t hash_a = hash_chars(chars, len, PRIME_A, num_buckets);
+	if (attempt == 0) {
+		return hash_a % num_buckets;
+	}
+	const size_t hash_b = hash_chars(chars, len, PRIME_B, num_buckets);
+	return (hash_a + (attempt * (hash_b + (hash_b == 0)))) % num_buckets;
+}
@@ -8,4 +8,8 @@
 size_t hash_function(const struct YASL_Object s, const size_t a, const size_t m);
 size_t get_hash(const struct YASL_Object s, const size_t num_buckets, const size_t attempt);
 
+// Same as hash_function and get_hash for a string object with the given contents, without needing the object.
+size_t hash_chars(const char *const chars, const size_t len, const size_t a, const size_t m);
+size_t get_hash_chars(const char *const chars, const size_t len, const size_t num_buckets, const size_t attempt);
+
 #endif
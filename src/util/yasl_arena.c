@@ -0,0 +1,67 @@
+#include "yasl_arena.h"
+
+#include <string.h>
+
+#include "yasl_conf.h"
+
+#define ARENA_MIN_CHUNK 4096
+#define ARENA_MAX_CHUNK (1 << 20)
+
+union ArenaAlign {
+	void *p;
+	yasl_int i;
+	yasl_float f;
+	size_t s;
+};
+
+#define ARENA_ALIGN (sizeof(union ArenaAlign))
+#define ARENA_ROUND(n) (((n) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+struct YASL_ArenaChunk {
+	struct YASL_ArenaChunk *prev;
+	size_t size;
+	union ArenaAlign data[];
+};
+
+static void *arena_grow(struct YASL_Arena *arena, size_t size) {
+	// Chunks double in size so that large compilations need few of them, up to a cap so that a small script does not
+	// hold on to megabytes it never uses.
+	size_t chunk_size = arena->chunk ? arena->chunk->size * 2 : ARENA_MIN_CHUNK;
+	if (chunk_size > ARENA_MAX_CHUNK) chunk_size = ARENA_MAX_CHUNK;
+	if (chunk_size < size) chunk_size = size;
+
+	struct YASL_ArenaChunk *chunk = (struct YASL_ArenaChunk *)malloc(sizeof(struct YASL_ArenaChunk) + chunk_size);
+	chunk->prev = arena->chunk;
+	chunk->size = chunk_size;
+	arena->chunk = chunk;
+	arena->next = (unsigned char *)chunk->data + size;
+	arena->end = (unsigned char *)chunk->data + chunk_size;
+	return chunk->data;
+}
+
+void *yasl_arena_alloc(struct YASL_Arena *arena, size_t size) {
+	size = ARENA_ROUND(size);
+	if ((size_t)(arena->end - arena->next) < size) {
+		return arena_grow(arena, size);
+	}
+	void *ptr = arena->next;
+	arena->next += size;
+	return ptr;
+}
+
+char *yasl_arena_strdup(struct YASL_Arena *arena, const char *str, size_t len) {
+	char *copy = (char *)yasl_arena_alloc(arena, len + 1);
+	if (len) memcpy(copy, str, len);
+	copy[len] = '\0';
+	return copy;
+}
+
+void yasl_arena_free(struct YASL_Arena *arena) {
+	struct YASL_ArenaChunk *chunk = arena->chunk;
+	while (chunk) {
+		struct YASL_ArenaChunk *prev = chunk->prev;
+		free(chunk);
+		chunk = prev;
+	}
+	*arena = NEW_ARENA();
+}
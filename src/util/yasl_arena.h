@@ -0,0 +1,31 @@
+#ifndef YASL_ARENA_H_
+#define YASL_ARENA_H_
+
+#include <stdlib.h>
+
+// Bump allocator for data that all dies at the same time, such as the AST of one compilation. Allocations cannot be
+// freed individually; yasl_arena_free releases all of them at once and leaves the arena ready for reuse.
+
+struct YASL_ArenaChunk;
+
+struct YASL_Arena {
+	struct YASL_ArenaChunk *chunk;  // most recently allocated chunk; older chunks are linked from it.
+	unsigned char *next;            // first free byte in chunk.
+	unsigned char *end;             // one past the last byte in chunk.
+};
+
+#define NEW_ARENA() ((struct YASL_Arena) { NULL, NULL, NULL })
+
+/**
+ * Allocates size bytes, suitably aligned for any object the compiler stores in the arena.
+ */
+void *yasl_arena_alloc(struct YASL_Arena *arena, size_t size);
+
+/**
+ * Copies the first len bytes of str into the arena, followed by a null terminator.
+ */
+char *yasl_arena_strdup(struct YASL_Arena *arena, const char *str, size_t len);
+
+void yasl_arena_free(struct YASL_Arena *arena);
+
+#endif
@@ -0,0 +1,218 @@
+#include "yasl_ascii.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YASL_ASCII_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#define ISSPACE(c) ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\v' || (c) == '\r')
+#define NEEDS_ESCAPE(c) ((unsigned char)(c) < 0x20 || (unsigned char)(c) >= 0x7F || (c) == '\'')
+
+#ifdef YASL_ASCII_SSE2
+#define BLOCK 16
+
+static inline unsigned lowest_bit(unsigned mask) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (unsigned)index;
+#else
+	return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+static inline unsigned highest_bit(unsigned mask) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse(&index, mask);
+	return (unsigned)index;
+#else
+	return 31 - (unsigned)__builtin_clz(mask);
+#endif
+}
+
+/* One bit per byte of block, set if that byte is whitespace. */
+static inline unsigned space_mask(const char *block) {
+	const __m128i v = _mm_loadu_si128((const __m128i *)block);
+	__m128i m = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+	m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+	m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+	m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\v')));
+	m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+	return (unsigned)_mm_movemask_epi8(m);
+}
+
+/* One bit per byte of block, set if that byte needs escaping. Bytes >= 0x80 compare as negative, so are < 0x20. */
+static inline unsigned escape_mask(const char *block) {
+	const __m128i v = _mm_loadu_si128((const __m128i *)block);
+	__m128i m = _mm_cmplt_epi8(v, _mm_set1_epi8(0x20));
+	m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F)));
+	m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\'')));
+	return (unsigned)_mm_movemask_epi8(m);
+}
+
+/* Flips bit 0x20 of every byte in [lo, hi]. */
+static inline void flip_case(char *dest, const char *src, const char lo, const char hi) {
+	const __m128i v = _mm_loadu_si128((const __m128i *)src);
+	const __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8((char)(lo - 1))),
+					       _mm_cmplt_epi8(v, _mm_set1_epi8((char)(hi + 1))));
+	_mm_storeu_si128((__m128i *)dest, _mm_xor_si128(v, _mm_and_si128(in_range, _mm_set1_epi8(0x20))));
+}
+#endif
+
+void ascii_toupper(char *dest, const char *src, const size_t len) {
+	size_t i = 0;
+#ifdef YASL_ASCII_SSE2
+	for (; i + BLOCK <= len; i += BLOCK) {
+		flip_case(dest + i, src + i, 'a', 'z');
+	}
+#endif
+	for (; i < len; i++) {
+		const char c = src[i];
+		dest[i] = 'a' <= c && c <= 'z' ? (char)(c & ~0x20) : c;
+	}
+}
+
+void ascii_tolower(char *dest, const char *src, const size_t len) {
+	size_t i = 0;
+#ifdef YASL_ASCII_SSE2
+	for (; i + BLOCK <= len; i += BLOCK) {
+		flip_case(dest + i, src + i, 'A', 'Z');
+	}
+#endif
+	for (; i < len; i++) {
+		const char c = src[i];
+		dest[i] = 'A' <= c && c <= 'Z' ? (char)(c | 0x20) : c;
+	}
+}
+
+size_t ascii_span_ascii(const char *chars, const size_t len) {
+	size_t i = 0;
+#ifdef YASL_ASCII_SSE2
+	for (; i + BLOCK <= len; i += BLOCK) {
+		const unsigned mask = (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(chars + i)));
+		if (mask) return i + lowest_bit(mask);
+	}
+#endif
+	while (i < len && (unsigned char)chars[i] < 0x80) {
+		i++;
+	}
+	return i;
+}
+
+size_t ascii_span_space(const char *chars, const size_t len) {
+	size_t i = 0;
+#ifdef YASL_ASCII_SSE2
+	for (; i + BLOCK <= len; i += BLOCK) {
+		const unsigned mask = space_mask(chars + i) ^ 0xFFFF;
+		if (mask) return i + lowest_bit(mask);
+	}
+#endif
+	while (i < len && ISSPACE(chars[i])) {
+		i++;
+	}
+	return i;
+}
+
+size_t ascii_cspan_space(const char *chars, const size_t len) {
+	size_t i = 0;
+#ifdef YASL_ASCII_SSE2
+	for (; i + BLOCK <= len; i += BLOCK) {
+		const unsigned mask = space_mask(chars + i);
+		if (mask) return i + lowest_bit(mask);
+	}
+#endif
+	while (i < len && !ISSPACE(chars[i])) {
+		i++;
+	}
+	return i;
+}
+
+size_t ascii_rspan_space(const char *chars, const size_t len) {
+	size_t end = len;
+#ifdef YASL_ASCII_SSE2
+	for (; end >= BLOCK; end -= BLOCK) {
+		const unsigned mask = space_mask(chars + end - BLOCK) ^ 0xFFFF;
+		if (mask) return len - (end - BLOCK + highest_bit(mask) + 1);
+	}
+#endif
+	while (end > 0 && ISSPACE(chars[end - 1])) {
+		end--;
+	}
+	return len - end;
+}
+
+/* Returns the number of bytes at the start of chars that can be copied without escaping. */
+static size_t span_plain(const char *chars, const size_t len) {
+	size_t i = 0;
+#ifdef YASL_ASCII_SSE2
+	for (; i + BLOCK <= len; i += BLOCK) {
+		const unsigned mask = escape_mask(chars + i);
+		if (mask) return i + lowest_bit(mask);
+	}
+#endif
+	while (i < len && !NEEDS_ESCAPE(chars[i])) {
+		i++;
+	}
+	return i;
+}
+
+static size_t escape_width(const char c) {
+	switch (c) {
+#define X(escape, c) case escape:
+#include "escapes.x"
+#undef X
+	case '\'':
+		return 2;
+	default:
+		return 4;
+	}
+}
+
+size_t ascii_escaped_len(const char *chars, const size_t len) {
+	size_t size = 0;
+	size_t i = 0;
+	while (i < len) {
+		const size_t plain = span_plain(chars + i, len - i);
+		size += plain;
+		i += plain;
+		if (i < len) {
+			size += escape_width(chars[i++]);
+		}
+	}
+	return size;
+}
+
+char *ascii_escape(char *dest, const char *chars, const size_t len) {
+	static const char hex[] = "0123456789abcdef";
+	size_t i = 0;
+	while (i < len) {
+		const size_t plain = span_plain(chars + i, len - i);
+		memcpy(dest, chars + i, plain);
+		dest += plain;
+		i += plain;
+		if (i >= len) break;
+
+		const unsigned char c = (unsigned char)chars[i++];
+		*dest++ = '\\';
+		switch (c) {
+#define X(escape, e) case escape: *dest++ = e; continue;
+#include "escapes.x"
+#undef X
+		case '\'':
+			*dest++ = '\'';
+			continue;
+		default:
+			*dest++ = 'x';
+			*dest++ = hex[c >> 4];
+			*dest++ = hex[c & 0xF];
+			continue;
+		}
+	}
+	return dest;
+}
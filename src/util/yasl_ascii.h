@@ -0,0 +1,54 @@
+#ifndef YASL_UTIL_ASCII_H_
+#define YASL_UTIL_ASCII_H_
+
+#include <stddef.h>
+
+/*
+ * Byte-classification kernels for strs. These work on 16 bytes at a time where SSE2 is available, and fall back to
+ * plain loops otherwise. Whitespace means the same set of bytes as iswhitespace in YASL_String.h.
+ */
+
+/**
+ * Copies len bytes from src to dest, converting ASCII lowercase letters to uppercase.
+ */
+void ascii_toupper(char *dest, const char *src, const size_t len);
+
+/**
+ * Copies len bytes from src to dest, converting ASCII uppercase letters to lowercase.
+ */
+void ascii_tolower(char *dest, const char *src, const size_t len);
+
+/**
+ * @return the number of ASCII (< 0x80) bytes at the start of chars.
+ */
+size_t ascii_span_ascii(const char *chars, const size_t len);
+
+/**
+ * @return the number of whitespace bytes at the start of chars.
+ */
+size_t ascii_span_space(const char *chars, const size_t len);
+
+/**
+ * @return the number of non-whitespace bytes at the start of chars.
+ */
+size_t ascii_cspan_space(const char *chars, const size_t len);
+
+/**
+ * @return the number of whitespace bytes at the end of chars.
+ */
+size_t ascii_rspan_space(const char *chars, const size_t len);
+
+/**
+ * @return the number of bytes needed by ascii_escape for the same input.
+ */
+size_t ascii_escaped_len(const char *chars, const size_t len);
+
+/**
+ * Writes chars to dest as they would appear inside a single-quoted str literal: escapes from escapes.x are used where
+ * possible, other non-printable bytes are written as \xNN, and single quotes are backslash-escaped. dest must have
+ * room for ascii_escaped_len(chars, len) bytes.
+ * @return a pointer just past the last byte written.
+ */
+char *ascii_escape(char *dest, const char *chars, const size_t len);
+
+#endif
@@ -0,0 +1,88 @@
+#include "yasl_filemap.h"
+
+#include "yasl_plat.h"
+
+#if defined(YASL_USE_UNIX) || defined(YASL_USE_APPLE)
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static bool filemap_map(struct YASL_FileMap *map, FILE *fp) {
+	const int fd = fileno(fp);
+	struct stat st;
+	if (fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size <= 0) return false;
+	void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED) return false;
+	map->data = (const unsigned char *)data;
+	map->len = (size_t)st.st_size;
+	return true;
+}
+
+static void filemap_unmap(struct YASL_FileMap *map) {
+	munmap((void *)map->data, map->len);
+}
+#elif defined(YASL_USE_WIN)
+#include <io.h>
+
+static bool filemap_map(struct YASL_FileMap *map, FILE *fp) {
+	HANDLE file = (HANDLE)_get_osfhandle(_fileno(fp));
+	LARGE_INTEGER size;
+	if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size) || size.QuadPart <= 0) return false;
+	HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapping) return false;
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	// The view keeps the mapping alive.
+	CloseHandle(mapping);
+	if (!data) return false;
+	map->data = (const unsigned char *)data;
+	map->len = (size_t)size.QuadPart;
+	return true;
+}
+
+static void filemap_unmap(struct YASL_FileMap *map) {
+	UnmapViewOfFile(map->data);
+}
+#else
+static bool filemap_map(struct YASL_FileMap *map, FILE *fp) {
+	(void)map;
+	(void)fp;
+	return false;
+}
+
+static void filemap_unmap(struct YASL_FileMap *map) {
+	(void)map;
+}
+#endif
+
+static bool filemap_read(struct YASL_FileMap *map, FILE *fp) {
+	if (fseek(fp, 0, SEEK_END)) return false;
+	const long len = ftell(fp);
+	if (len <= 0 || fseek(fp, 0, SEEK_SET)) return false;
+	unsigned char *data = (unsigned char *)malloc((size_t)len);
+	if (!data) return false;
+	if (fread(data, 1, (size_t)len, fp) != (size_t)len) {
+		free(data);
+		return false;
+	}
+	map->data = data;
+	map->len = (size_t)len;
+	return true;
+}
+
+bool yasl_filemap_open(struct YASL_FileMap *map, FILE *fp) {
+	*map = NEW_FILEMAP();
+	if (filemap_map(map, fp)) {
+		map->is_mapped = true;
+		return true;
+	}
+	return filemap_read(map, fp);
+}
+
+void yasl_filemap_close(struct YASL_FileMap *map) {
+	if (!map->data) return;
+	if (map->is_mapped) {
+		filemap_unmap(map);
+	} else {
+		free((void *)map->data);
+	}
+	*map = NEW_FILEMAP();
+}
@@ -0,0 +1,29 @@
+#ifndef YASL_FILEMAP_H_
+#define YASL_FILEMAP_H_
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Read-only view of a whole file. Where the platform supports it the file is memory-mapped, so its pages are shared
+// with every other process and state that maps the same file; elsewhere it is read into memory.
+
+struct YASL_FileMap {
+	const unsigned char *data;
+	size_t len;
+	bool is_mapped;
+};
+
+#define NEW_FILEMAP() ((struct YASL_FileMap) { NULL, 0, false })
+
+/**
+ * Maps the file open as fp. The file may be closed afterwards.
+ * @param map receives the view of the file.
+ * @param fp the file to map.
+ * @return true on success, false if the file is empty or could not be read.
+ */
+bool yasl_filemap_open(struct YASL_FileMap *map, FILE *fp);
+
+void yasl_filemap_close(struct YASL_FileMap *map);
+
+#endif
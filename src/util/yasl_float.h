@@ -1,8 +1,36 @@
 #ifndef YASL_UTIL_BUILTINS_H_
 #define YASL_UTIL_BUILTINS_H_
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #include "yasl_conf.h"
 
+// Large enough for any result of float64_to_buf, including the terminating null.
+#define YASL_FLOAT_BUFF_LEN 32
+
+/**
+ * Writes the shortest representation of d that reads back as d into buffer, which must hold at least
+ * YASL_FLOAT_BUFF_LEN chars. Does not allocate.
+ * @param buffer the buffer to write to.
+ * @param d the float to format.
+ * @return the length of the result, excluding the null terminator.
+ */
+size_t float64_to_buf(char *buffer, const yasl_float d);
+
+/**
+ * Like float64_to_buf, but returns a copy allocated with malloc, which the caller must free.
+ */
 const char *float64_to_str(const yasl_float d);
 
+/**
+ * Parses a decimal float of the form 1.5, 1.5e10, 1.e-3 or 1_000.0. '_' separators are skipped, except directly after
+ * the '.'. Does not allocate, except for a rare fallback on inputs that are both long and ambiguous.
+ * @param chars the chars to parse.
+ * @param len the number of chars.
+ * @param result where to store the parsed value, rounded to nearest.
+ * @return true if all len chars form a float, false otherwise.
+ */
+bool float64_parse(const char *chars, const size_t len, yasl_float *result);
+
 #endif
@@ -0,0 +1,73 @@
+#include "yasl_int.h"
+
+static uint64_t load_8chars(const char *chars) {
+	const unsigned char *bytes = (const unsigned char *)chars;
+	return (uint64_t)bytes[0] | (uint64_t)bytes[1] << 8 | (uint64_t)bytes[2] << 16 | (uint64_t)bytes[3] << 24 |
+	       (uint64_t)bytes[4] << 32 | (uint64_t)bytes[5] << 40 | (uint64_t)bytes[6] << 48 | (uint64_t)bytes[7] << 56;
+}
+
+bool int64_is_8digits(const char *chars) {
+	const uint64_t val = load_8chars(chars);
+	return ((val & UINT64_C(0xF0F0F0F0F0F0F0F0)) |
+		(((val + UINT64_C(0x0606060606060606)) & UINT64_C(0xF0F0F0F0F0F0F0F0)) >> 4)) == UINT64_C(0x3333333333333333);
+}
+
+uint32_t int64_parse_8digits(const char *chars) {
+	uint64_t val = load_8chars(chars);
+	const uint64_t mask = 0x000000FF000000FF;
+	const uint64_t mul1 = 0x000F424000000064;  // 100 + (1000000ULL << 32)
+	const uint64_t mul2 = 0x0000271000000001;  // 1 + (10000ULL << 32)
+	val -= UINT64_C(0x3030303030303030);
+	val = (val * 10) + (val >> 8);  // val = (val * 2561) >> 8;
+	val = (((val & mask) * mul1) + (((val >> 16) & mask) * mul2)) >> 32;
+	return (uint32_t)val;
+}
+
+static int digit_value(const char c) {
+	if ('0' <= c && c <= '9') return c - '0';
+	if ('a' <= c && c <= 'f') return c - 'a' + 10;
+	if ('A' <= c && c <= 'F') return c - 'A' + 10;
+	return 16;
+}
+
+bool int64_parse(const char *chars, const size_t len, const int base, yasl_int *result) {
+	size_t i = 0;
+	const bool negative = len > 0 && chars[0] == '-';
+	if (len > 0 && (chars[0] == '-' || chars[0] == '+')) {
+		i++;
+	}
+
+	const uint64_t limit = (uint64_t)INT64_MAX + negative;
+	uint64_t value = 0;
+	bool overflow = false;
+
+	if (i == len || digit_value(chars[i]) >= base) {
+		return false;
+	}
+
+	while (i < len) {
+		if (base == 10 && i + 8 <= len && value <= limit / 100000000 && int64_is_8digits(chars + i)) {
+			value = value * 100000000 + int64_parse_8digits(chars + i);
+			i += 8;
+			continue;
+		}
+		if (chars[i] != '_') {
+			const int digit = digit_value(chars[i]);
+			if (digit >= base) {
+				return false;
+			}
+			if (value > (limit - (uint64_t)digit) / (uint64_t)base) {
+				overflow = true;
+			} else {
+				value = value * (uint64_t)base + (uint64_t)digit;
+			}
+		}
+		i++;
+	}
+
+	if (overflow || value > limit) {
+		value = limit;
+	}
+	*result = negative ? (yasl_int)(0 - value) : (yasl_int)value;
+	return true;
+}
@@ -0,0 +1,31 @@
+#ifndef YASL_UTIL_INT_H_
+#define YASL_UTIL_INT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "yasl_conf.h"
+
+/**
+ * Checks whether the 8 chars starting at chars are all decimal digits.
+ */
+bool int64_is_8digits(const char *chars);
+
+/**
+ * Parses exactly 8 decimal digits at once. Assumes int64_is_8digits(chars).
+ */
+uint32_t int64_parse_8digits(const char *chars);
+
+/**
+ * Parses an int in base 2, 10 or 16, with an optional sign but no prefix. '_' separators are skipped, but the first
+ * char after the sign must be a digit. Values that do not fit in a yasl_int saturate, like strtoll. Does not allocate.
+ * @param chars the chars to parse.
+ * @param len the number of chars.
+ * @param base the base, one of 2, 10 or 16.
+ * @param result where to store the parsed value.
+ * @return true if all len chars were consumed, false otherwise.
+ */
+bool int64_parse(const char *chars, const size_t len, const int base, yasl_int *result);
+
+#endif
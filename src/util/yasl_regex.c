@@ -0,0 +1,852 @@
+#include "yasl_regex.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_REPEAT 1000
+#define MAX_DEPTH 1000
+#define MAX_PROGRAM 100000
+#define MAX_GROUPS 100
+#define MAX_CAPTURE_SLOTS (1 << 22)
+#define NONE ((size_t)-1)
+
+#define CLASS_TEST(cls, c) ((cls)->bits[(unsigned char)(c) >> 5] & ((uint32_t)1 << ((unsigned char)(c) & 31)))
+#define CLASS_ADD(cls, c) ((cls)->bits[(unsigned char)(c) >> 5] |= ((uint32_t)1 << ((unsigned char)(c) & 31)))
+#define IS_WORD(c) (('a' <= (c) && (c) <= 'z') || ('A' <= (c) && (c) <= 'Z') || ('0' <= (c) && (c) <= '9') || (c) == '_')
+
+struct ReClass {
+	uint32_t bits[8];
+};
+
+enum ReOp {
+	OP_BYTE,
+	OP_CLASS,
+	OP_ANY,
+	OP_SPLIT,   // try x, then y
+	OP_JMP,
+	OP_SAVE,    // record the current position in capture slot x
+	OP_BOL,
+	OP_EOL,
+	OP_WORDB,
+	OP_NWORDB,
+	OP_MATCH
+};
+
+struct ReInst {
+	enum ReOp op;
+	unsigned char byte;
+	size_t x;
+	size_t y;
+};
+
+struct ReThreadList {
+	size_t count;
+	size_t *pcs;
+	size_t *caps;  // count * (2 * num_groups) capture slots, one set per thread
+};
+
+/* Work item for adding threads: either follow pc, or put a capture slot back the way it was. */
+struct ReFrame {
+	bool restore;
+	size_t pc;
+	size_t slot;
+	size_t value;
+};
+
+struct YASL_Regex {
+	struct ReInst *code;
+	size_t code_len;
+	struct ReClass *classes;
+	size_t num_groups;
+	bool has_first;
+	struct ReClass first;  // bytes that can start a match, if has_first
+	/* Scratch space for regex_exec, sized for this program. */
+	struct ReThreadList lists[2];
+	size_t *marks;
+	struct ReFrame *stack;
+	size_t *work;
+};
+
+/********************************************************************************
+ *                                    Parser                                    *
+ ********************************************************************************/
+
+enum ReNodeType {
+	N_EMPTY,
+	N_BYTE,
+	N_CLASS,
+	N_ANY,
+	N_CAT,      // children from left, linked through next
+	N_ALT,      // children from left, linked through next
+	N_REPEAT,
+	N_GROUP,
+	N_BOL,
+	N_EOL,
+	N_WORDB,
+	N_NWORDB
+};
+
+struct ReNode {
+	enum ReNodeType type;
+	unsigned char byte;
+	bool greedy;
+	int min;
+	int max;        // -1 for no upper bound
+	size_t index;   // class index or group number
+	size_t left;
+	size_t next;
+};
+
+struct ReParser {
+	const char *pattern;
+	size_t len;
+	size_t pos;
+	size_t depth;
+	struct ReNode *nodes;
+	size_t num_nodes;
+	size_t nodes_size;
+	struct ReClass *classes;
+	size_t num_classes;
+	size_t classes_size;
+	size_t num_groups;
+	const char *error;
+};
+
+static size_t parse_alt(struct ReParser *p);
+
+static size_t parser_fail(struct ReParser *p, const char *error) {
+	if (!p->error) p->error = error;
+	return NONE;
+}
+
+static size_t new_node(struct ReParser *p, enum ReNodeType type) {
+	if (p->num_nodes == p->nodes_size) {
+		p->nodes_size = p->nodes_size ? p->nodes_size * 2 : 16;
+		p->nodes = (struct ReNode *)realloc(p->nodes, p->nodes_size * sizeof(struct ReNode));
+	}
+	struct ReNode *node = p->nodes + p->num_nodes;
+	memset(node, 0, sizeof(*node));
+	node->type = type;
+	node->left = NONE;
+	node->next = NONE;
+	return p->num_nodes++;
+}
+
+static size_t new_class(struct ReParser *p) {
+	if (p->num_classes == p->classes_size) {
+		p->classes_size = p->classes_size ? p->classes_size * 2 : 4;
+		p->classes = (struct ReClass *)realloc(p->classes, p->classes_size * sizeof(struct ReClass));
+	}
+	memset(p->classes + p->num_classes, 0, sizeof(struct ReClass));
+	return p->num_classes++;
+}
+
+static void class_add_range(struct ReClass *cls, int lo, int hi) {
+	for (int c = lo; c <= hi; c++) {
+		CLASS_ADD(cls, c);
+	}
+}
+
+static void class_invert(struct ReClass *cls) {
+	for (int i = 0; i < 8; i++) {
+		cls->bits[i] = ~cls->bits[i];
+	}
+}
+
+/* Adds the class for \d, \w, \s or their negations to cls. Returns false if c names no such class. */
+static bool escape_class(struct ReClass *cls, const char c) {
+	struct ReClass tmp;
+	memset(&tmp, 0, sizeof(tmp));
+	switch (c) {
+	case 'd': case 'D':
+		class_add_range(&tmp, '0', '9');
+		break;
+	case 'w': case 'W':
+		class_add_range(&tmp, 'a', 'z');
+		class_add_range(&tmp, 'A', 'Z');
+		class_add_range(&tmp, '0', '9');
+		CLASS_ADD(&tmp, '_');
+		break;
+	case 's': case 'S':
+		CLASS_ADD(&tmp, ' ');
+		class_add_range(&tmp, '\t', '\r');
+		break;
+	default:
+		return false;
+	}
+	if (c == 'D' || c == 'W' || c == 'S') class_invert(&tmp);
+	for (int i = 0; i < 8; i++) {
+		cls->bits[i] |= tmp.bits[i];
+	}
+	return true;
+}
+
+static int hex_value(const char c) {
+	if ('0' <= c && c <= '9') return c - '0';
+	if ('a' <= c && c <= 'f') return c - 'a' + 10;
+	if ('A' <= c && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+/* Parses the byte escape after a '\'. Returns -1 on error. */
+static int parse_escape_byte(struct ReParser *p) {
+	const char c = p->pattern[p->pos++];
+	switch (c) {
+	case 'n': return '\n';
+	case 't': return '\t';
+	case 'r': return '\r';
+	case 'f': return '\f';
+	case 'v': return '\v';
+	case 'a': return '\a';
+	case '0': return '\0';
+	case 'x': {
+		if (p->pos + 2 > p->len) break;
+		const int hi = hex_value(p->pattern[p->pos]);
+		const int lo = hex_value(p->pattern[p->pos + 1]);
+		if (hi < 0 || lo < 0) break;
+		p->pos += 2;
+		return hi * 16 + lo;
+	}
+	default:
+		if (!IS_WORD(c)) return (unsigned char)c;
+		break;
+	}
+	parser_fail(p, "invalid escape");
+	return -1;
+}
+
+static size_t parse_class(struct ReParser *p) {
+	const size_t start = p->pos++;
+	const size_t index = new_class(p);
+	const bool negate = p->pos < p->len && p->pattern[p->pos] == '^';
+	if (negate) p->pos++;
+
+	bool first = true;
+	while (p->pos < p->len && (p->pattern[p->pos] != ']' || first)) {
+		first = false;
+		int lo;
+		if (p->pattern[p->pos] == '\\') {
+			if (++p->pos >= p->len) break;
+			if (escape_class(p->classes + index, p->pattern[p->pos])) {
+				p->pos++;
+				continue;
+			}
+			if ((lo = parse_escape_byte(p)) < 0) return NONE;
+		} else {
+			lo = (unsigned char)p->pattern[p->pos++];
+		}
+
+		if (p->pos + 1 < p->len && p->pattern[p->pos] == '-' && p->pattern[p->pos + 1] != ']') {
+			p->pos++;
+			int hi;
+			if (p->pattern[p->pos] == '\\') {
+				p->pos++;
+				if (p->pos >= p->len) break;
+				if ((hi = parse_escape_byte(p)) < 0) return NONE;
+			} else {
+				hi = (unsigned char)p->pattern[p->pos++];
+			}
+			if (hi < lo) return parser_fail(p, "invalid class range");
+			class_add_range(p->classes + index, lo, hi);
+		} else {
+			CLASS_ADD(p->classes + index, lo);
+		}
+	}
+
+	if (p->pos >= p->len) {
+		p->pos = start;
+		return parser_fail(p, "unterminated class");
+	}
+	p->pos++;
+
+	if (negate) class_invert(p->classes + index);
+	const size_t node = new_node(p, N_CLASS);
+	p->nodes[node].index = index;
+	return node;
+}
+
+static size_t parse_atom(struct ReParser *p) {
+	const char c = p->pattern[p->pos];
+	size_t node;
+	switch (c) {
+	case '(': {
+		if (++p->depth > MAX_DEPTH) return parser_fail(p, "pattern nested too deeply");
+		const size_t start = p->pos++;
+		size_t group = 0;
+		if (p->pos + 1 < p->len && p->pattern[p->pos] == '?' && p->pattern[p->pos + 1] == ':') {
+			p->pos += 2;
+		} else {
+			if (p->num_groups == MAX_GROUPS) {
+				p->pos = start;
+				return parser_fail(p, "too many groups");
+			}
+			group = ++p->num_groups;
+		}
+		const size_t inner = parse_alt(p);
+		if (inner == NONE) return NONE;
+		if (p->pos >= p->len || p->pattern[p->pos] != ')') {
+			p->pos = start;
+			return parser_fail(p, "unterminated group");
+		}
+		p->pos++;
+		p->depth--;
+		if (!group) return inner;
+		node = new_node(p, N_GROUP);
+		p->nodes[node].index = group;
+		p->nodes[node].left = inner;
+		return node;
+	}
+	case '[':
+		return parse_class(p);
+	case '*': case '+': case '?':
+		return parser_fail(p, "nothing to repeat");
+	case '.':
+		p->pos++;
+		return new_node(p, N_ANY);
+	case '^':
+		p->pos++;
+		return new_node(p, N_BOL);
+	case '$':
+		p->pos++;
+		return new_node(p, N_EOL);
+	case '\\': {
+		if (++p->pos >= p->len) return parser_fail(p, "trailing backslash");
+		const char e = p->pattern[p->pos];
+		if (e == 'b' || e == 'B') {
+			p->pos++;
+			return new_node(p, e == 'b' ? N_WORDB : N_NWORDB);
+		}
+		const size_t index = new_class(p);
+		if (escape_class(p->classes + index, e)) {
+			p->pos++;
+			node = new_node(p, N_CLASS);
+			p->nodes[node].index = index;
+			return node;
+		}
+		p->num_classes--;
+		const int b = parse_escape_byte(p);
+		if (b < 0) return NONE;
+		node = new_node(p, N_BYTE);
+		p->nodes[node].byte = (unsigned char)b;
+		return node;
+	}
+	default:
+		p->pos++;
+		node = new_node(p, N_BYTE);
+		p->nodes[node].byte = (unsigned char)c;
+		return node;
+	}
+}
+
+static bool parse_int(struct ReParser *p, int *result) {
+	if (p->pos >= p->len || p->pattern[p->pos] < '0' || p->pattern[p->pos] > '9') return false;
+	int n = 0;
+	while (p->pos < p->len && '0' <= p->pattern[p->pos] && p->pattern[p->pos] <= '9') {
+		if (n <= MAX_REPEAT) n = n * 10 + (p->pattern[p->pos] - '0');
+		p->pos++;
+	}
+	*result = n;
+	return true;
+}
+
+/* Parses a `{m}`, `{m,}` or `{m,n}` quantifier. Leaves pos alone and returns false if there is none here. */
+static bool parse_braces(struct ReParser *p, int *min, int *max) {
+	const size_t start = p->pos++;
+	if (!parse_int(p, min)) {
+		p->pos = start;
+		return false;
+	}
+	*max = *min;
+	if (p->pos < p->len && p->pattern[p->pos] == ',') {
+		p->pos++;
+		if (!parse_int(p, max)) *max = -1;
+	}
+	if (p->pos >= p->len || p->pattern[p->pos] != '}') {
+		p->pos = start;
+		return false;
+	}
+	p->pos++;
+	return true;
+}
+
+static size_t parse_repeat(struct ReParser *p) {
+	size_t node = parse_atom(p);
+	size_t wraps = 0;
+	while (node != NONE && p->pos < p->len) {
+		const size_t start = p->pos;
+		int min, max;
+		switch (p->pattern[p->pos]) {
+		case '*': min = 0; max = -1; p->pos++; break;
+		case '+': min = 1; max = -1; p->pos++; break;
+		case '?': min = 0; max = 1; p->pos++; break;
+		case '{':
+			if (parse_braces(p, &min, &max)) break;
+			return node;
+		default:
+			return node;
+		}
+		if (min > MAX_REPEAT || max > MAX_REPEAT || (max >= 0 && max < min)) {
+			p->pos = start;
+			return parser_fail(p, "invalid repetition count");
+		}
+		if (++wraps > MAX_DEPTH) return parser_fail(p, "pattern nested too deeply");
+
+		const size_t repeat = new_node(p, N_REPEAT);
+		p->nodes[repeat].min = min;
+		p->nodes[repeat].max = max;
+		p->nodes[repeat].greedy = true;
+		p->nodes[repeat].left = node;
+		if (p->pos < p->len && p->pattern[p->pos] == '?') {
+			p->nodes[repeat].greedy = false;
+			p->pos++;
+		}
+		node = repeat;
+	}
+	return node;
+}
+
+static size_t parse_cat(struct ReParser *p) {
+	const size_t cat = new_node(p, N_CAT);
+	size_t last = NONE;
+	while (p->pos < p->len && p->pattern[p->pos] != '|' && p->pattern[p->pos] != ')') {
+		const size_t item = parse_repeat(p);
+		if (item == NONE) return NONE;
+		if (last == NONE) {
+			p->nodes[cat].left = item;
+		} else {
+			p->nodes[last].next = item;
+		}
+		last = item;
+	}
+	return cat;
+}
+
+static size_t parse_alt(struct ReParser *p) {
+	size_t first = parse_cat(p);
+	if (first == NONE || p->pos >= p->len || p->pattern[p->pos] != '|') return first;
+
+	const size_t alt = new_node(p, N_ALT);
+	p->nodes[alt].left = first;
+	size_t last = first;
+	while (p->pos < p->len && p->pattern[p->pos] == '|') {
+		p->pos++;
+		const size_t item = parse_cat(p);
+		if (item == NONE) return NONE;
+		p->nodes[last].next = item;
+		last = item;
+	}
+	return alt;
+}
+
+/********************************************************************************
+ *                                   Compiler                                   *
+ ********************************************************************************/
+
+struct ReCompiler {
+	const struct ReNode *nodes;
+	struct ReInst *code;
+	size_t len;
+	size_t size;
+	bool too_big;
+};
+
+static size_t emit(struct ReCompiler *c, enum ReOp op, size_t x) {
+	if (c->len >= MAX_PROGRAM) {
+		c->too_big = true;
+		return c->len - 1;
+	}
+	if (c->len == c->size) {
+		c->size = c->size ? c->size * 2 : 16;
+		c->code = (struct ReInst *)realloc(c->code, c->size * sizeof(struct ReInst));
+	}
+	c->code[c->len].op = op;
+	c->code[c->len].byte = 0;
+	c->code[c->len].x = x;
+	c->code[c->len].y = 0;
+	return c->len++;
+}
+
+static void compile_node(struct ReCompiler *c, size_t index) {
+	if (c->too_big) return;
+	const struct ReNode *node = c->nodes + index;
+	switch (node->type) {
+	case N_EMPTY:
+		break;
+	case N_BYTE: {
+		/* emit may move c->code, so it must be called before c->code is read. */
+		const size_t inst = emit(c, OP_BYTE, 0);
+		c->code[inst].byte = node->byte;
+		break;
+	}
+	case N_CLASS:
+		emit(c, OP_CLASS, node->index);
+		break;
+	case N_ANY:
+		emit(c, OP_ANY, 0);
+		break;
+	case N_BOL:
+		emit(c, OP_BOL, 0);
+		break;
+	case N_EOL:
+		emit(c, OP_EOL, 0);
+		break;
+	case N_WORDB:
+		emit(c, OP_WORDB, 0);
+		break;
+	case N_NWORDB:
+		emit(c, OP_NWORDB, 0);
+		break;
+	case N_GROUP:
+		emit(c, OP_SAVE, 2 * node->index);
+		compile_node(c, node->left);
+		emit(c, OP_SAVE, 2 * node->index + 1);
+		break;
+	case N_CAT:
+		for (size_t child = node->left; child != NONE; child = c->nodes[child].next) {
+			compile_node(c, child);
+		}
+		break;
+	case N_ALT: {
+		/* Each alternative but the last is split x: alternative, y: the rest, and jumps to the end after. */
+		size_t jumps = NONE;
+		for (size_t child = node->left; child != NONE && !c->too_big; child = c->nodes[child].next) {
+			size_t split = NONE;
+			if (c->nodes[child].next != NONE) {
+				split = emit(c, OP_SPLIT, c->len + 1);
+			}
+			compile_node(c, child);
+			if (split != NONE) {
+				const size_t jump = emit(c, OP_JMP, jumps);
+				jumps = jump;
+				c->code[split].y = c->len;
+			}
+		}
+		/* Patch the chain of jumps, threaded through x, to point past the last alternative. */
+		while (jumps != NONE && !c->too_big) {
+			const size_t next = c->code[jumps].x;
+			c->code[jumps].x = c->len;
+			jumps = next;
+		}
+		break;
+	}
+	case N_REPEAT: {
+		if (node->max < 0) {
+			/*
+			 * The last required copy loops back to itself: body; split body, out. A pass through the body that
+			 * matches nothing still counts, like in backtracking engines, since it reaches the split before the
+			 * repeated visit to the body is cut off.
+			 */
+			size_t entry = NONE;
+			for (int i = 0; i < node->min - 1; i++) {
+				compile_node(c, node->left);
+			}
+			if (node->min == 0) {
+				entry = emit(c, OP_SPLIT, 0);
+			}
+			const size_t body = c->len;
+			compile_node(c, node->left);
+			const size_t split = emit(c, OP_SPLIT, 0);
+			if (c->too_big) break;
+			c->code[split].x = node->greedy ? body : c->len;
+			c->code[split].y = node->greedy ? c->len : body;
+			if (entry != NONE) {
+				c->code[entry].x = node->greedy ? body : c->len;
+				c->code[entry].y = node->greedy ? c->len : body;
+			}
+			break;
+		}
+		for (int i = 0; i < node->min; i++) {
+			compile_node(c, node->left);
+		}
+		/* Optional copies, each of which skips to the very end when not taken. */
+		const size_t first_split = c->len;
+		for (int i = node->min; i < node->max && !c->too_big; i++) {
+			emit(c, OP_SPLIT, 0);
+			compile_node(c, node->left);
+		}
+		for (size_t pc = first_split; pc < c->len && !c->too_big; pc++) {
+			if (c->code[pc].op == OP_SPLIT && c->code[pc].x == 0 && c->code[pc].y == 0) {
+				c->code[pc].x = node->greedy ? pc + 1 : c->len;
+				c->code[pc].y = node->greedy ? c->len : pc + 1;
+			}
+		}
+		break;
+	}
+	}
+}
+
+/*
+ * Works out which bytes can start a match, so that regex_exec can skip ahead when it has no live threads. Gives up if
+ * a match could start with an assertion or be empty.
+ */
+static void compute_first(struct YASL_Regex *re) {
+	bool *seen = (bool *)calloc(re->code_len, sizeof(bool));
+	size_t *stack = (size_t *)malloc((2 * re->code_len + 1) * sizeof(size_t));
+	size_t top = 0;
+	memset(&re->first, 0, sizeof(re->first));
+	re->has_first = true;
+	stack[top++] = 0;
+	while (top > 0 && re->has_first) {
+		const size_t pc = stack[--top];
+		if (seen[pc]) continue;
+		seen[pc] = true;
+		const struct ReInst *inst = re->code + pc;
+		switch (inst->op) {
+		case OP_BYTE:
+			CLASS_ADD(&re->first, inst->byte);
+			break;
+		case OP_CLASS:
+			for (int i = 0; i < 8; i++) re->first.bits[i] |= re->classes[inst->x].bits[i];
+			break;
+		case OP_ANY:
+			re->has_first = false;
+			break;
+		case OP_SPLIT:
+			stack[top++] = inst->y;
+			stack[top++] = inst->x;
+			break;
+		case OP_JMP:
+			stack[top++] = inst->x;
+			break;
+		case OP_SAVE:
+			stack[top++] = pc + 1;
+			break;
+		default:
+			re->has_first = false;
+			break;
+		}
+	}
+	free(seen);
+	free(stack);
+}
+
+struct YASL_Regex *regex_compile(const char *pattern, const size_t len, const char **error, size_t *error_pos) {
+	struct ReParser p;
+	memset(&p, 0, sizeof(p));
+	p.pattern = pattern;
+	p.len = len;
+
+	size_t root = parse_alt(&p);
+	if (root != NONE && p.pos < len) {
+		root = parser_fail(&p, "unmatched ')'");
+	}
+
+	struct ReCompiler c;
+	memset(&c, 0, sizeof(c));
+	c.nodes = p.nodes;
+	if (root != NONE) {
+		emit(&c, OP_SAVE, 0);
+		compile_node(&c, root);
+		emit(&c, OP_SAVE, 1);
+		emit(&c, OP_MATCH, 0);
+		// Each thread holds a full set of captures, and there can be one thread per instruction.
+		if (c.too_big || c.len * 2 * (p.num_groups + 1) > MAX_CAPTURE_SLOTS) {
+			p.pos = 0;
+			root = parser_fail(&p, "pattern too large");
+		}
+	}
+	free(p.nodes);
+
+	if (root == NONE) {
+		*error = p.error;
+		*error_pos = p.pos;
+		free(p.classes);
+		free(c.code);
+		return NULL;
+	}
+
+	struct YASL_Regex *re = (struct YASL_Regex *)malloc(sizeof(struct YASL_Regex));
+	re->code = c.code;
+	re->code_len = c.len;
+	re->classes = p.classes;
+	re->num_groups = p.num_groups + 1;
+	compute_first(re);
+
+	const size_t ncap = 2 * re->num_groups;
+	for (int i = 0; i < 2; i++) {
+		re->lists[i].count = 0;
+		re->lists[i].pcs = (size_t *)malloc(c.len * sizeof(size_t));
+		re->lists[i].caps = (size_t *)malloc(c.len * ncap * sizeof(size_t));
+	}
+	re->marks = (size_t *)malloc(c.len * sizeof(size_t));
+	re->stack = (struct ReFrame *)malloc((2 * c.len + 1) * sizeof(struct ReFrame));
+	re->work = (size_t *)malloc(ncap * sizeof(size_t));
+	if (!re->lists[0].pcs || !re->lists[0].caps || !re->lists[1].pcs || !re->lists[1].caps ||
+	    !re->marks || !re->stack || !re->work) {
+		regex_del(re);
+		*error = "out of memory";
+		*error_pos = 0;
+		return NULL;
+	}
+	return re;
+}
+
+void regex_del(struct YASL_Regex *re) {
+	if (!re) return;
+	free(re->code);
+	free(re->classes);
+	for (int i = 0; i < 2; i++) {
+		free(re->lists[i].pcs);
+		free(re->lists[i].caps);
+	}
+	free(re->marks);
+	free(re->stack);
+	free(re->work);
+	free(re);
+}
+
+size_t regex_num_groups(const struct YASL_Regex *re) {
+	return re->num_groups;
+}
+
+/********************************************************************************
+ *                                    Pike VM                                   *
+ ********************************************************************************/
+
+/*
+ * Adds a thread at pc to list, following jumps, splits, saves and assertions at pos. Threads are added in priority
+ * order, and each pc at most once per position, which is what bounds the work per input byte.
+ */
+static void add_thread(struct YASL_Regex *re, struct ReThreadList *list, const size_t pc, const size_t *caps,
+		       const char *chars, const size_t len, const size_t pos, const size_t gen) {
+	const size_t ncap = 2 * re->num_groups;
+	size_t *work = re->work;
+	struct ReFrame *stack = re->stack;
+	size_t top = 0;
+	memcpy(work, caps, ncap * sizeof(size_t));
+
+	stack[top].restore = false;
+	stack[top++].pc = pc;
+	while (top > 0) {
+		const struct ReFrame frame = stack[--top];
+		if (frame.restore) {
+			work[frame.slot] = frame.value;
+			continue;
+		}
+		if (re->marks[frame.pc] == gen) continue;
+		re->marks[frame.pc] = gen;
+
+		const struct ReInst *inst = re->code + frame.pc;
+		bool follow = false;
+		switch (inst->op) {
+		case OP_JMP:
+			stack[top].restore = false;
+			stack[top++].pc = inst->x;
+			continue;
+		case OP_SPLIT:
+			stack[top].restore = false;
+			stack[top++].pc = inst->y;
+			stack[top].restore = false;
+			stack[top++].pc = inst->x;
+			continue;
+		case OP_SAVE:
+			stack[top].restore = true;
+			stack[top].slot = inst->x;
+			stack[top++].value = work[inst->x];
+			work[inst->x] = pos;
+			follow = true;
+			break;
+		case OP_BOL:
+			follow = pos == 0;
+			break;
+		case OP_EOL:
+			follow = pos == len;
+			break;
+		case OP_WORDB:
+		case OP_NWORDB: {
+			const bool before = pos > 0 && IS_WORD(chars[pos - 1]);
+			const bool after = pos < len && IS_WORD(chars[pos]);
+			follow = (before != after) == (inst->op == OP_WORDB);
+			break;
+		}
+		default:
+			list->pcs[list->count] = frame.pc;
+			memcpy(list->caps + list->count * ncap, work, ncap * sizeof(size_t));
+			list->count++;
+			continue;
+		}
+		if (follow) {
+			stack[top].restore = false;
+			stack[top++].pc = frame.pc + 1;
+		}
+	}
+}
+
+bool regex_exec(struct YASL_Regex *re, const char *chars, const size_t len, const size_t start, const bool anchored,
+		size_t *caps) {
+	if (start > len) return false;
+
+	const size_t ncap = 2 * re->num_groups;
+	struct ReThreadList *clist = re->lists;
+	struct ReThreadList *nlist = re->lists + 1;
+	clist->count = 0;
+	memset(re->marks, 0, re->code_len * sizeof(size_t));
+	for (size_t i = 0; i < ncap; i++) {
+		caps[i] = REGEX_NO_MATCH;
+	}
+
+	bool matched = false;
+	size_t pos = start;
+	while (true) {
+		if (!matched && (!anchored || pos == start)) {
+			if (clist->count == 0 && !anchored && re->has_first) {
+				while (pos < len && !CLASS_TEST(&re->first, chars[pos])) {
+					pos++;
+				}
+				if (pos == len) break;
+			}
+			add_thread(re, clist, 0, caps, chars, len, pos, pos - start + 1);
+		}
+		if (clist->count == 0) {
+			/* Every thread died, but an unanchored search can still start a new one further on. */
+			if (matched || anchored || pos >= len) break;
+			pos++;
+			continue;
+		}
+
+		nlist->count = 0;
+		const unsigned char c = pos < len ? (unsigned char)chars[pos] : 0;
+		for (size_t i = 0; i < clist->count; i++) {
+			const size_t pc = clist->pcs[i];
+			const size_t *tcaps = clist->caps + i * ncap;
+			const struct ReInst *inst = re->code + pc;
+			bool step = false;
+			switch (inst->op) {
+			case OP_MATCH:
+				matched = true;
+				memcpy(caps, tcaps, ncap * sizeof(size_t));
+				/* Threads after this one have lower priority, so they can never win. */
+				i = clist->count;
+				continue;
+			case OP_BYTE:
+				step = pos < len && c == inst->byte;
+				break;
+			case OP_CLASS:
+				step = pos < len && CLASS_TEST(re->classes + inst->x, c);
+				break;
+			case OP_ANY:
+				step = pos < len && c != '\n';
+				break;
+			default:
+				break;
+			}
+			if (step) {
+				add_thread(re, nlist, pc + 1, tcaps, chars, len, pos + 1, pos - start + 2);
+			}
+		}
+
+		struct ReThreadList *tmp = clist;
+		clist = nlist;
+		nlist = tmp;
+		if (pos >= len) break;
+		pos++;
+	}
+
+	if (!matched) {
+		for (size_t i = 0; i < ncap; i++) {
+			caps[i] = REGEX_NO_MATCH;
+		}
+	}
+	return matched;
+}
@@ -0,0 +1,54 @@
+#ifndef YASL_UTIL_REGEX_H_
+#define YASL_UTIL_REGEX_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Byte-oriented regular expressions. Patterns are compiled to a program for a Pike VM, which simulates the NFA
+ * breadth-first, so matching takes O(len(pattern) * len(input)) steps on any input; there is no backtracking. Each step
+ * may copy the thread's capture positions, so the time is O(len(pattern) * groups * len(input)) for a pattern with
+ * capture groups. Patterns are limited to 100 groups, and are rejected as too large if their threads' captures would
+ * take too much memory.
+ * Matches are leftmost-first, as in Perl: alternatives and quantifiers are tried in priority order. The one difference
+ * is in loops whose body can match nothing, where an empty pass never ends the loop early.
+ *
+ * Supported syntax:
+ *   literals, `.` (any byte but '\n'), `[...]` and `[^...]` with ranges,
+ *   `\d \D \w \W \s \S`, `\b \B`, `\n \t \r \f \v \0 \xHH` and escaped punctuation,
+ *   `^ $` (start and end of input), `(...)`, `(?:...)`, `|`,
+ *   `* + ? {m} {m,} {m,n}`, each optionally followed by `?` to make it lazy.
+ */
+
+#define REGEX_NO_MATCH ((size_t)-1)
+
+struct YASL_Regex;
+
+/**
+ * Compiles pattern.
+ * @param pattern the pattern to compile.
+ * @param len the length of pattern.
+ * @param error set to a description of the problem if the pattern is invalid.
+ * @param error_pos set to the offset in pattern at which the problem was found.
+ * @return the compiled pattern, or NULL if it is invalid.
+ */
+struct YASL_Regex *regex_compile(const char *pattern, const size_t len, const char **error, size_t *error_pos);
+
+void regex_del(struct YASL_Regex *re);
+
+/**
+ * @return the number of capture groups, counting the whole match as group 0.
+ */
+size_t regex_num_groups(const struct YASL_Regex *re);
+
+/**
+ * Finds the leftmost-first match of re in chars, starting no earlier than start.
+ * @param caps receives 2 * regex_num_groups(re) offsets: the start and end of each group, or REGEX_NO_MATCH for groups
+ * that did not take part in the match.
+ * @param anchored if true, only matches starting exactly at start are considered.
+ * @return true if a match was found.
+ */
+bool regex_exec(struct YASL_Regex *re, const char *chars, const size_t len, const size_t start, const bool anchored,
+		size_t *caps);
+
+#endif
@@ -0,0 +1,89 @@
+#include "yasl_thread.h"
+
+#include <stdbool.h>
+
+#include "yasl_plat.h"
+
+#if defined(YASL_USE_UNIX) || defined(YASL_USE_APPLE)
+#include <pthread.h>
+#endif
+
+struct ThreadStart {
+	yasl_thread_fn fn;
+	void *task;
+};
+
+#if defined(YASL_USE_UNIX) || defined(YASL_USE_APPLE)
+typedef pthread_t yasl_thread;
+
+static void *thread_start(void *arg) {
+	struct ThreadStart *start = (struct ThreadStart *)arg;
+	start->fn(start->task);
+	return NULL;
+}
+
+static bool thread_create(yasl_thread *thread, struct ThreadStart *start) {
+	return pthread_create(thread, NULL, &thread_start, start) == 0;
+}
+
+static void thread_join(yasl_thread thread) {
+	pthread_join(thread, NULL);
+}
+#elif defined(YASL_USE_WIN)
+typedef HANDLE yasl_thread;
+
+static DWORD WINAPI thread_start(LPVOID arg) {
+	struct ThreadStart *start = (struct ThreadStart *)arg;
+	start->fn(start->task);
+	return 0;
+}
+
+static bool thread_create(yasl_thread *thread, struct ThreadStart *start) {
+	*thread = CreateThread(NULL, 0, &thread_start, start, 0, NULL);
+	return *thread != NULL;
+}
+
+static void thread_join(yasl_thread thread) {
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+}
+#else
+typedef int yasl_thread;
+
+static bool thread_create(yasl_thread *thread, struct ThreadStart *start) {
+	(void)thread;
+	(void)start;
+	return false;
+}
+
+static void thread_join(yasl_thread thread) {
+	(void)thread;
+}
+#endif
+
+void yasl_thread_run_all(yasl_thread_fn fn, void *tasks, size_t task_size, size_t n) {
+	if (n == 0) return;
+
+	yasl_thread *threads = (yasl_thread *)malloc(n * sizeof(yasl_thread));
+	struct ThreadStart *starts = (struct ThreadStart *)malloc(n * sizeof(struct ThreadStart));
+	bool *started = (bool *)malloc(n * sizeof(bool));
+
+	for (size_t i = 1; i < n; i++) {
+		starts[i] = (struct ThreadStart) { fn, (char *)tasks + i * task_size };
+		started[i] = thread_create(threads + i, starts + i);
+	}
+
+	fn(tasks);
+
+	for (size_t i = 1; i < n; i++) {
+		if (started[i]) {
+			thread_join(threads[i]);
+		} else {
+			fn((char *)tasks + i * task_size);
+		}
+	}
+
+	free(threads);
+	free(starts);
+	free(started);
+}
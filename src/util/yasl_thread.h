@@ -0,0 +1,20 @@
+#ifndef YASL_THREAD_H_
+#define YASL_THREAD_H_
+
+#include <stdlib.h>
+
+// Minimal fork-join threading, used to split up work that doesn't touch any YASL_State.
+
+typedef void (*yasl_thread_fn)(void *);
+
+/**
+ * Calls fn on each of the n tasks in tasks, using one thread per task, and waits for all of them to finish. The
+ * calling thread runs one of the tasks itself. If threads are unavailable, the tasks are run one after another.
+ * @param fn the function to run.
+ * @param tasks array of n tasks, each task_size bytes.
+ * @param task_size size of each task in bytes.
+ * @param n number of tasks.
+ */
+void yasl_thread_run_all(yasl_thread_fn fn, void *tasks, size_t task_size, size_t n);
+
+#endif
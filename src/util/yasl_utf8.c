@@ -0,0 +1,49 @@
+#include "yasl_utf8.h"
+
+#include "yasl_ascii.h"
+
+#define IS_CONT(c) (((c) & 0xC0) == 0x80)
+
+size_t utf8_count(const char *chars, const size_t len) {
+	const unsigned char *s = (const unsigned char *)chars;
+	size_t count = 0;
+	size_t i = 0;
+	while (i < len) {
+		const size_t ascii = ascii_span_ascii(chars + i, len - i);
+		count += ascii;
+		i += ascii;
+		if (i >= len) break;
+
+		const unsigned char c = s[i];
+		const size_t left = len - i;
+		if (c < 0xC2) {
+			return UTF8_INVALID;
+		} else if (c < 0xE0) {
+			if (left < 2 || !IS_CONT(s[i + 1])) return UTF8_INVALID;
+			i += 2;
+		} else if (c < 0xF0) {
+			if (left < 3 || !IS_CONT(s[i + 2])) return UTF8_INVALID;
+			const unsigned char lo = c == 0xE0 ? 0xA0 : 0x80;
+			const unsigned char hi = c == 0xED ? 0x9F : 0xBF;
+			if (s[i + 1] < lo || s[i + 1] > hi) return UTF8_INVALID;
+			i += 3;
+		} else if (c < 0xF5) {
+			if (left < 4 || !IS_CONT(s[i + 2]) || !IS_CONT(s[i + 3])) return UTF8_INVALID;
+			const unsigned char lo = c == 0xF0 ? 0x90 : 0x80;
+			const unsigned char hi = c == 0xF4 ? 0x8F : 0xBF;
+			if (s[i + 1] < lo || s[i + 1] > hi) return UTF8_INVALID;
+			i += 4;
+		} else {
+			return UTF8_INVALID;
+		}
+		count++;
+	}
+	return count;
+}
+
+size_t utf8_seq_len(const unsigned char lead) {
+	if (lead < 0x80) return 1;
+	if (lead < 0xE0) return 2;
+	if (lead < 0xF0) return 3;
+	return 4;
+}
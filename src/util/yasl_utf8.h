@@ -0,0 +1,20 @@
+#ifndef YASL_UTIL_UTF8_H_
+#define YASL_UTIL_UTF8_H_
+
+#include <stddef.h>
+
+#define UTF8_INVALID ((size_t)-1)
+
+/**
+ * Validates chars as UTF-8, rejecting overlong forms, surrogates and code points above U+10FFFF. Runs of ASCII are
+ * skipped a block at a time.
+ * @return the number of code points in chars, or UTF8_INVALID.
+ */
+size_t utf8_count(const char *chars, const size_t len);
+
+/**
+ * @return the number of bytes in the code point starting with lead. Assumes the input is valid UTF-8.
+ */
+size_t utf8_seq_len(const unsigned char lead);
+
+#endif
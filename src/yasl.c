@@ -3,6 +3,7 @@
 #include <ctype.h>
 #include <stdarg.h>
 
+#include "common/bytecode.h"
 #include "compiler/compiler.h"
 #include "compiler/lexinput.h"
 #include "src/interpreter/methods/table_methods.h"
@@ -21,6 +22,8 @@ static struct YASL_State *YASL_newstate_helper(struct LEXINPUT *lexinput, size_t
 	S->compiler = tcomp;
 	S->compiler.header->count = 24;
 	S->compiler.num = num;
+	S->image = NEW_FILEMAP();
+	S->bytecode = NULL;
 
 	vm_init((struct VM *) S, NULL, -1, num + 1);
 
@@ -55,6 +58,149 @@ struct YASL_State *YASL_newstate(const char *filename) {
 	return YASL_newstate_helper(lexinput_new_file(fp), 0);
 }
 
+/*
+ * Checks that the constant table and offsets at the start of program lie within it, so that a truncated or corrupt
+ * file is rejected here rather than read out of bounds by the VM.
+ */
+static bool bytecode_program_isvalid(const unsigned char *program, const int64_t len) {
+	if (len < 3 * (int64_t)sizeof(int64_t) + 1) return false;
+	const int64_t entry_point = ((const int64_t *)program)[0];
+	const int64_t line_start = ((const int64_t *)program)[1];
+	const int64_t num_constants = ((const int64_t *)program)[2];
+	if (entry_point < 3 * (int64_t)sizeof(int64_t) || line_start <= entry_point || line_start > len ||
+	    program[line_start - 1] != O_HALT || num_constants < 0) {
+		return false;
+	}
+
+	int64_t offset = 3 * sizeof(int64_t);
+	for (int64_t i = 0; i < num_constants; i++) {
+		if (offset >= entry_point) return false;
+		int64_t size;
+		switch (program[offset++]) {
+		case C_STR:
+			if (entry_point - offset < (int64_t)sizeof(int64_t)) return false;
+			memcpy(&size, program + offset, sizeof(int64_t));
+			if (size < 0 || size > entry_point - offset) return false;
+			size += sizeof(int64_t);
+			break;
+		case C_INT_1:
+			size = 1;
+			break;
+		case C_INT_8:
+			size = sizeof(int64_t);
+			break;
+		case C_FLOAT:
+			size = sizeof(yasl_float);
+			break;
+		default:
+			return false;
+		}
+		if (size > entry_point - offset) return false;
+		offset += size;
+	}
+	return true;
+}
+
+/*
+ * Checks the file header of image and returns the program that follows it, or NULL if the image was not written on a
+ * compatible machine from source with the given hash.
+ */
+static unsigned char *bytecode_program(const struct YASL_FileMap *image, const uint64_t source_hash) {
+	if (image->len < YASL_BYTECODE_FILE_HEADER_LEN) return NULL;
+	const unsigned char *header = image->data;
+
+	int64_t endian_check, len;
+	uint64_t hash;
+	memcpy(&endian_check, header + 8, sizeof(int64_t));
+	memcpy(&len, header + 16, sizeof(int64_t));
+	memcpy(&hash, header + 24, sizeof(uint64_t));
+	if (memcmp(header, YASL_BYTECODE_MAGIC, YASL_BYTECODE_MAGIC_LEN) ||
+	    header[4] != YASL_BYTECODE_VERSION ||
+	    header[5] != sizeof(yasl_int) ||
+	    header[6] != sizeof(yasl_float) ||
+	    endian_check != YASL_BYTECODE_ENDIAN_CHECK ||
+	    hash != source_hash ||
+	    len <= 0 || (uint64_t)len != image->len - YASL_BYTECODE_FILE_HEADER_LEN) {
+		return NULL;
+	}
+
+	unsigned char *program = (unsigned char *)image->data + YASL_BYTECODE_FILE_HEADER_LEN;
+	return bytecode_program_isvalid(program, len) ? program : NULL;
+}
+
+struct YASL_State *YASL_newstate_bytecode(const char *filename) {
+	FILE *fp = fopen(filename, "rb");
+	if (!fp) {
+		return NULL;  // Can't open file.
+	}
+
+	struct YASL_FileMap image;
+	const bool loaded = yasl_filemap_open(&image, fp);
+	fclose(fp);
+	if (!loaded) {
+		return NULL;
+	}
+
+	unsigned char *program = bytecode_program(&image, 0);
+	if (!program) {
+		yasl_filemap_close(&image);
+		return NULL;
+	}
+
+	struct YASL_State *S = YASL_newstate_helper(lexinput_new_bb("", 0), 0);
+	S->image = image;
+	if (!compiler_intern_constants(&S->compiler, program)) {
+		YASL_delstate(S);
+		return NULL;
+	}
+	S->bytecode = program;
+	return S;
+}
+
+struct YASL_State *YASL_newstate_copy(const struct YASL_State *S, const char *buf, size_t len) {
+	struct YASL_State *copy = (struct YASL_State *)malloc(sizeof(struct YASL_State));
+
+	struct Compiler tcomp = NEW_COMPILER(lexinput_new_bb(buf, len));
+	copy->compiler = tcomp;
+	copy->compiler.header->count = 24;
+	compiler_copy_globals(&copy->compiler, &S->compiler);
+	copy->compiler.parser.lex.err.print = S->compiler.parser.lex.err.print;
+	copy->image = NEW_FILEMAP();
+	copy->bytecode = NULL;
+
+	if (!vm_init_copy((struct VM *) copy, (const struct VM *) S)) {
+		YASL_delstate(copy);
+		return NULL;
+	}
+	return copy;
+}
+
+static bool bytecode_write(FILE *fp, const unsigned char *program, const int64_t len, const uint64_t source_hash) {
+	const int64_t endian_check = YASL_BYTECODE_ENDIAN_CHECK;
+	unsigned char header[YASL_BYTECODE_FILE_HEADER_LEN] = { 0 };
+	memcpy(header, YASL_BYTECODE_MAGIC, YASL_BYTECODE_MAGIC_LEN);
+	header[4] = YASL_BYTECODE_VERSION;
+	header[5] = sizeof(yasl_int);
+	header[6] = sizeof(yasl_float);
+	memcpy(header + 8, &endian_check, sizeof(int64_t));
+	memcpy(header + 16, &len, sizeof(int64_t));
+	memcpy(header + 24, &source_hash, sizeof(uint64_t));
+
+	bool ok = fwrite(header, 1, sizeof(header), fp) == sizeof(header) &&
+		  fwrite(program, 1, (size_t)len, fp) == (size_t)len;
+	return !fclose(fp) && ok;
+}
+
+int YASL_savebytecode(struct YASL_State *S, const char *filename) {
+	unsigned char *program = compile(&S->compiler);
+	if (!program) return S->compiler.status;
+
+	FILE *fp = fopen(filename, "wb");
+	const bool ok = fp && bytecode_write(fp, program, (int64_t)compiler_bytecode_size(&S->compiler), 0);
+	free(program);
+	return ok ? YASL_SUCCESS : YASL_ERROR;
+}
+
 int YASL_resetstate(struct YASL_State *S, const char *filename) {
 	FILE *fp = fopen(filename, "rb");
 	if (!fp) {
@@ -100,6 +246,7 @@ int YASL_delstate(struct YASL_State *S) {
 
 	compiler_cleanup(&S->compiler);
 	vm_cleanup((struct VM *) S);
+	yasl_filemap_close(&S->image);
 	free(S);
 	return YASL_SUCCESS;
 }
@@ -151,6 +298,7 @@ int YASL_execute_REPL(struct YASL_State *S) {
 
 	S->vm.pc = bc + entry_point;
 	S->vm.code = bc;
+	S->vm.code_is_image = false;
 	S->vm.headers[S->compiler.num] = bc;
 
 	return vm_run((struct VM *)S);  // TODO: error handling for runtime errors.
@@ -165,23 +313,95 @@ int YASL_compile(struct YASL_State *S) {
 	return S->compiler.status;
 }
 
-int YASL_execute(struct YASL_State *S) {
-	unsigned char *bc = compile(&S->compiler);
-	if (!bc) return S->compiler.status;
-
+static int execute_program(struct YASL_State *S, unsigned char *bc, const bool is_image) {
 	int64_t entry_point = *((int64_t *) bc);
 	// TODO: use this in VM.
 	// int64_t num_globals = *((int64_t*)bc+1);
 
 	S->vm.pc = bc + entry_point;
 	S->vm.code = bc;
-	S->vm.headers[S->compiler.num] = bc;
+	S->vm.code_is_image = is_image;
+	// The image is owned by S, not the VM.
+	if (!is_image) S->vm.headers[S->compiler.num] = bc;
 
 	int result = vm_run((struct VM *) S);  // TODO: error handling for runtime errors.
 
 	return result;
 }
 
+int YASL_execute(struct YASL_State *S) {
+	const bool is_image = S->bytecode != NULL;
+	S->compiler.lazy_fns = true;
+	unsigned char *bc = is_image ? S->bytecode : compile(&S->compiler);
+	S->bytecode = NULL;
+	if (!bc) return S->compiler.status;
+
+	return execute_program(S, bc, is_image);
+}
+
+int YASL_execute_fn(struct YASL_State *S) {
+	unsigned char *bc = compile_fn(&S->compiler);
+	if (!bc) return S->compiler.status;
+
+	return execute_program(S, bc, false);
+}
+
+/*
+ * Loads the program cached in cache_filename, if it was compiled from source with the given hash against the same
+ * constants that S's compiler holds now. Returns a copy that the caller owns, or NULL on a miss.
+ */
+static unsigned char *bytecode_load_cached(struct YASL_State *S, const char *cache_filename, const uint64_t source_hash) {
+	FILE *fp = fopen(cache_filename, "rb");
+	if (!fp) return NULL;
+
+	struct YASL_FileMap image;
+	const bool loaded = yasl_filemap_open(&image, fp);
+	fclose(fp);
+	if (!loaded) return NULL;
+
+	unsigned char *bc = NULL;
+	const unsigned char *program = bytecode_program(&image, source_hash);
+	if (program && compiler_intern_constants(&S->compiler, program)) {
+		const size_t len = image.len - YASL_BYTECODE_FILE_HEADER_LEN;
+		bc = (unsigned char *)malloc(len);
+		memcpy(bc, program, len);
+	}
+	yasl_filemap_close(&image);
+	return bc;
+}
+
+/*
+ * Writes to a temporary file first, so that other processes never load a partly written cache.
+ */
+static void bytecode_save_cached(struct YASL_State *S, const unsigned char *bc, const char *cache_filename,
+				 const uint64_t source_hash) {
+	const size_t name_len = strlen(cache_filename);
+	char *tmp_filename = (char *)malloc(name_len + 5);
+	memcpy(tmp_filename, cache_filename, name_len);
+	strcpy(tmp_filename + name_len, ".tmp");
+
+	FILE *fp = fopen(tmp_filename, "wb");
+	if (fp && bytecode_write(fp, bc, (int64_t)compiler_bytecode_size(&S->compiler), source_hash)) {
+		remove(cache_filename);
+		if (rename(tmp_filename, cache_filename)) remove(tmp_filename);
+	} else if (fp) {
+		remove(tmp_filename);
+	}
+	free(tmp_filename);
+}
+
+int YASL_execute_cached(struct YASL_State *S, const char *cache_filename, const uint64_t source_hash) {
+	unsigned char *bc = bytecode_load_cached(S, cache_filename, source_hash);
+	if (!bc) {
+		S->compiler.lazy_fns = true;
+		bc = compile(&S->compiler);
+		if (!bc) return S->compiler.status;
+		bytecode_save_cached(S, bc, cache_filename, source_hash);
+	}
+
+	return execute_program(S, bc, false);
+}
+
 int YASL_declglobal(struct YASL_State *S, const char *name) {
 #ifdef YASL_DEBUG
 	const char *curr = name;
@@ -193,8 +413,9 @@ int YASL_declglobal(struct YASL_State *S, const char *name) {
 		curr++;
 	}
 #endif  // YASL_DEBUG
-	compiler_intern_string(&S->compiler, name, strlen(name));
-	scope_decl_var(S->compiler.globals, name);
+	const size_t name_len = strlen(name);
+	compiler_intern_string(&S->compiler, name, name_len);
+	scope_decl_var(S->compiler.globals, symboltable_intern(&S->compiler.symbols, name, name_len));
 	return YASL_SUCCESS;
 }
 
@@ -204,22 +425,24 @@ static inline int is_const(int64_t value) {
 }
 
 int YASL_setglobal(struct YASL_State *S, const char *name) {
-	if (!scope_contains(S->compiler.globals, name)) return YASL_ERROR;
+	const int64_t symbol = symboltable_find(&S->compiler.symbols, name, strlen(name));
+	if (symbol < 0 || !scope_contains(S->compiler.globals, symbol)) return YASL_ERROR;
 
-	int64_t index = scope_get(S->compiler.globals, name);
+	int64_t index = scope_get(S->compiler.globals, symbol);
 	if (is_const(index)) return YASL_ERROR;
 
-	struct YASL_String *string = YASL_String_new_copyz((struct VM *)S, name);
-	YASL_Table_insert_fast(S->vm.globals, YASL_STR(string), vm_peek((struct VM *) S));
+	const size_t name_len = strlen(name);
+	if (!YASL_Table_replace_string(S->vm.globals, name, name_len, vm_peek((struct VM *) S))) {
+		struct YASL_String *string = YASL_String_new_copy((struct VM *)S, name, name_len);
+		YASL_Table_insert_fast(S->vm.globals, YASL_STR(string), vm_peek((struct VM *) S));
+	}
 	YASL_pop(S);
 
 	return YASL_SUCCESS;
 }
 
 int YASL_loadglobal(struct YASL_State *S, const char *name) {
-	struct YASL_String *string = YASL_String_new_copyz_unbound(name);
-	struct YASL_Object global = YASL_Table_search(S->vm.globals, YASL_STR(string));
-	str_del(string);
+	struct YASL_Object global = YASL_Table_search_zstring(S->vm.globals, name);
 	if (global.type == Y_END) {
 		return YASL_ERROR;
 	}
@@ -228,17 +451,18 @@ int YASL_loadglobal(struct YASL_State *S, const char *name) {
 }
 
 int YASL_registermt(struct YASL_State *S, const char *name) {
-	struct YASL_String *string = YASL_String_new_copyz((struct VM *)S, name);
-	YASL_Table_insert_fast(S->vm.metatables, YASL_STR(string), vm_peek((struct VM *) S));
+	const size_t name_len = strlen(name);
+	if (!YASL_Table_replace_string(S->vm.metatables, name, name_len, vm_peek((struct VM *) S))) {
+		struct YASL_String *string = YASL_String_new_copy((struct VM *)S, name, name_len);
+		YASL_Table_insert_fast(S->vm.metatables, YASL_STR(string), vm_peek((struct VM *) S));
+	}
 	YASL_pop(S);
 
 	return YASL_SUCCESS;
 }
 
 int YASL_loadmt(struct YASL_State *S, const char *name) {
-	struct YASL_String *string = YASL_String_new_copyz_unbound(name);
-	struct YASL_Object mt = YASL_Table_search(S->vm.metatables, YASL_STR(string));
-	str_del(string);
+	struct YASL_Object mt = YASL_Table_search_zstring(S->vm.metatables, name);
 	if (mt.type == Y_END) {
 		return YASL_ERROR;
 	}
@@ -262,6 +486,10 @@ int YASL_setmt(struct YASL_State *S) {
 	return YASL_SUCCESS;
 }
 
+void YASL_setnumthreads(struct YASL_State *S, unsigned num_threads) {
+	S->vm.num_threads = num_threads ? num_threads : 1;
+}
+
 void YASL_print_err(struct YASL_State *S, const char *const fmt, ...) {
 	va_list args;
 	va_start(args, fmt);
@@ -423,6 +651,30 @@ int YASL_tableset(struct YASL_State *S) {
 	return YASL_SUCCESS;
 }
 
+int YASL_tablesetfield(struct YASL_State *S, const char *key) {
+	struct YASL_Object value = vm_pop(&S->vm);
+	struct YASL_Object table = vm_peek(&S->vm);
+
+	if (!obj_istable(&table))
+		return YASL_TYPE_ERROR;
+	const size_t key_len = strlen(key);
+	if (!YASL_Table_replace_string(YASL_GETTABLE(table), key, key_len, value)) {
+		struct YASL_String *string = YASL_String_new_copy(&S->vm, key, key_len);
+		YASL_Table_insert_fast(YASL_GETTABLE(table), YASL_STR(string), value);
+	}
+	return YASL_SUCCESS;
+}
+
+int YASL_tablegetfield(struct YASL_State *S, const char *key) {
+	struct YASL_Object table = vm_peek(&S->vm);
+
+	if (!obj_istable(&table))
+		return YASL_TYPE_ERROR;
+	struct YASL_Object value = YASL_Table_search_zstring(YASL_GETTABLE(table), key);
+	vm_push(&S->vm, value.type == Y_END ? YASL_UNDEF() : value);
+	return YASL_SUCCESS;
+}
+
 void list___get_helper(struct YASL_State *S, struct YASL_List *ls, yasl_int index);
 
 void vm_len_unop(struct VM *const vm, int target, int source);
@@ -57,6 +57,7 @@ int YASL_decllib_io(struct YASL_State *S);
 int YASL_decllib_math(struct YASL_State *S);
 int YASL_decllib_mt(struct YASL_State *S);
 int YASL_decllib_os(struct YASL_State *S);
+int YASL_decllib_re(struct YASL_State *S);
 int YASL_decllib_require(struct YASL_State *S);
 int YASL_decllib_require_c(struct YASL_State *S);
 int YASL_decllib_try(struct YASL_State *S);
@@ -96,6 +97,16 @@ int YASL_execute(struct YASL_State *S);
  */
 int YASL_execute_REPL(struct YASL_State *S);
 
+/**
+ * [-0, +0]
+ * Compiles the source for the given YASL_State and writes the result to a bytecode file, which
+ * YASL_newstate_bytecode can later run without compiling it again.
+ * @param S the YASL_State containing the YASL source code to be compiled.
+ * @param filename the name of the file to write.
+ * @return 0 on success, otherwise an error code.
+ */
+int YASL_savebytecode(struct YASL_State *S, const char *filename);
+
 /**
  * [-n-1, +r]
  * Calls a function with n parameters. The function should be located below all n
@@ -326,6 +337,30 @@ YASL_WARN_UNUSED struct YASL_State *YASL_newstate(const char *filename);
  */
 YASL_WARN_UNUSED struct YASL_State *YASL_newstate_bb(const char *buf, size_t len);
 
+/**
+ * Initialises a new YASL_State that runs a bytecode file written by YASL_savebytecode. Calling
+ * YASL_execute on it runs the bytecode. Where possible the file is memory-mapped read-only and
+ * its string constants are used in place, so states running the same file share its memory.
+ * @param filename the name of the bytecode file.
+ * @return the new YASL_State, or NULL if the file can't be read or was not written by a compatible
+ * version of YASL.
+ */
+YASL_WARN_UNUSED struct YASL_State *YASL_newstate_bytecode(const char *filename);
+
+/**
+ * Initialises a new YASL_State with copies of the global variables, metatables and builtin methods
+ * of S, as if the same libraries had been declared in it. Copying is much cheaper than declaring
+ * them again, so a state that has had its libraries declared can be kept as a template, and copied
+ * each time a fresh state is needed. S is only read, so copies can be made from several threads at
+ * once, as long as nothing changes S meanwhile. Its stack is not copied.
+ * @param S the state to copy.
+ * @param buf buffer containing the source code used to initialize the new state.
+ * @param len the length of the buffer.
+ * @return the new YASL_State, or NULL if S holds values that can't be copied: functions defined
+ * in YASL, and userdata that owns its data, such as open files.
+ */
+YASL_WARN_UNUSED struct YASL_State *YASL_newstate_copy(const struct YASL_State *S, const char *buf, size_t len);
+
 /**
  * [-0, +0]
  * Returns the bool value of the top of the stack, if it is a boolean.
@@ -393,7 +428,7 @@ YASL_WARN_UNUSED yasl_int YASL_peeknint(struct YASL_State *S, unsigned n);
 /**
  * [-0, +0]
  * Returns the str value at index n, if it is a str.
- * Otherwise returns NULL. Does not modify the stack.
+ * Otherwise returns NULL. Does not modify the stack. The returned chars are not NUL-terminated; use len.
  * @param S the YASL_State.
  * @param n the index of the stack to check.
  * @outparam len the length of the string, filled only if the return value is non-NULL.
@@ -679,6 +714,15 @@ int YASL_setglobal(struct YASL_State *S, const char *name);
  */
 int YASL_setmt(struct YASL_State *S);
 
+/**
+ * [-0, +0]
+ * Sets the maximum number of threads YASL may use for internal work that runs no YASL code, such as sorting large
+ * lists of numbers or strings. The default is 1, meaning no extra threads are used.
+ * @param S the YASL_State
+ * @param num_threads the maximum number of threads to use. 0 is treated as 1.
+ */
+void YASL_setnumthreads(struct YASL_State *S, unsigned num_threads);
+
 void YASL_setprintout_tostr(struct YASL_State *S);
 
 void YASL_setprinterr_tostr(struct YASL_State *S);
@@ -717,6 +761,27 @@ bool YASL_tablenext(struct YASL_State *S);
  */
 int YASL_tableset(struct YASL_State *S);
 
+/**
+ * [-1, +0]
+ * sets the value of the string key `key` in a table. The topmost item is the value, then the table. The value is
+ * popped from the stack, while the table remains on top. Unlike YASL_tableset, this does not allocate the key unless
+ * it is new to the table.
+ * @param S the YASL_State which has the 2 items on top of the stack.
+ * @param key the key, as a null-terminated string.
+ * @return YASL_SUCCESS on success, else error code
+ */
+int YASL_tablesetfield(struct YASL_State *S, const char *key);
+
+/**
+ * [-0, +1]
+ * pushes the value of the string key `key` in the table on top of the stack, or undef if there is no such key. The
+ * table remains on the stack, below the value.
+ * @param S the YASL_State which has the table on top of the stack.
+ * @param key the key, as a null-terminated string.
+ * @return YASL_SUCCESS on success, else error code
+ */
+int YASL_tablegetfield(struct YASL_State *S, const char *key);
+
 /**
  * [-0, +0]
  * Causes a fatal error.
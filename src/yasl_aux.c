@@ -10,6 +10,7 @@ int YASLX_decllibs(struct YASL_State *S) {
 	YASL_decllib_math(S);
 	YASL_decllib_mt(S);
 	YASL_decllib_os(S);
+	YASL_decllib_re(S);
 	YASL_decllib_require(S);
 	YASL_decllib_require_c(S);
 	YASL_decllib_try(S);
@@ -136,8 +137,7 @@ static bool YASLX_functions_issentinal(struct YASLX_function functions) {
 void YASLX_tablesetfunctions(struct YASL_State *S, const struct YASLX_function functions[]) {
 	for (int i = 0; !YASLX_functions_issentinal(functions[i]); i++) {
 		struct YASLX_function function = functions[i];
-		YASL_pushlit(S, function.name);
 		YASL_pushcfunction(S, function.fn, function.args);
-		YASL_tableset(S);
+		YASL_tablesetfield(S, function.name);
 	}
 }
\ No newline at end of file
@@ -138,7 +138,7 @@ void YASLX_checknundef(struct YASL_State *S, const char *name, unsigned n);
 /**
  * [-0, +0]
  * Returns the nth position of the stack if it is a str. Otherwise, causes a type error, along with a printed
- * error message.
+ * error message. The returned chars are not NUL-terminated; use len.
  * @param S The YASL_State.
  * @param name Name of the function in which this is called, used for error message.
  * @param pos the position of the argument.
@@ -77,4 +77,15 @@
 #define YASL_DEFAULT_PATH ""
 #endif
 
+// @@ YASL_MODULE_CACHE_DIR
+// Name of the directory, next to each module loaded by require, in which its compiled bytecode is cached. The cache
+// writes to the directories modules are loaded from, so it is off unless this is defined, e.g. by building with
+// -DMODULE_CACHE=ON.
+// #define YASL_MODULE_CACHE_DIR "__yaslcache__"
+
+// @@ YASL_LAZY_FN_MIN_LEN
+// When running a script or module, functions whose source is at least this many bytes long are compiled when they are
+// first called, rather than up front. Comment out to always compile them up front.
+#define YASL_LAZY_FN_MIN_LEN 256
+
 #endif
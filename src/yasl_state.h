@@ -3,11 +3,14 @@
 
 #include "compiler/compiler.h"
 #include "interpreter/VM.h"
+#include "util/yasl_filemap.h"
 
 // VM MUST BE FIRST ITEM IN YASL_State SO THAT FUNCTIONS CAN RUN PROPERLY
 struct YASL_State {
     struct VM vm;
     struct Compiler compiler;
+    struct YASL_FileMap image;  // bytecode file loaded by YASL_newstate_bytecode; string constants borrow from it
+    unsigned char *bytecode;    // program within image, run by the next call to YASL_execute
 };
 
 #endif
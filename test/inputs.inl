@@ -64,6 +64,9 @@ static const char *inputs[] = {
   "test/inputs/builtin-types/list/count.yasl",
   "test/inputs/builtin-types/list/remove.yasl",
   "test/inputs/builtin-types/list/sort.yasl",
+  "test/inputs/builtin-types/list/sort_large.yasl",
+  "test/inputs/builtin-types/list/sort_throw.yasl",
+  "test/inputs/builtin-types/list/sortby.yasl",
   "test/inputs/builtin-types/list/slice.yasl",
   "test/inputs/builtin-types/list/__len.yasl",
   "test/inputs/builtin-types/list/__eq.yasl",
@@ -177,12 +180,15 @@ static const char *inputs[] = {
   "test/inputs/std/collections/table.yasl",
   "test/inputs/std/collections/set_comp.yasl",
   "test/inputs/std/collections/list.yasl",
+  "test/inputs/std/collections/deque.yasl",
   "test/inputs/std/io_setformat.yasl",
   "test/inputs/std/io.yasl",
   "test/inputs/std/math/min-max.yasl",
   "test/inputs/std/math/math.yasl",
   "test/inputs/std/require/ifdef.yasl",
   "test/inputs/std/require/require.yasl",
+  "test/inputs/std/require/eval.yasl",
+  "test/inputs/std/require/fail.yasl",
   "test/inputs/std/mt/setmt.yasl",
   "test/inputs/std/mt/mt.yasl",
   "test/inputs/std/try.yasl",
@@ -231,6 +237,7 @@ static const char *inputs[] = {
   "test/inputs/closures/two.yasl",
   "test/inputs/closures/multi.yasl",
   "test/inputs/closures/deep.yasl",
+  "test/inputs/closures/lazy.yasl",
   "test/inputs/closures/location_closed.yasl",
   "test/inputs/closures/deep_assign.yasl",
   "test/inputs/closures/simple.yasl",
@@ -240,4 +247,11 @@ static const char *inputs[] = {
   "test/inputs/closures/loop.yasl",
   "test/inputs/closures/local.yasl",
   "test/inputs/closures/assign.yasl",
+  "test/inputs/builtin-types/str/search_long.yasl",
+  "test/inputs/builtin-types/str/concat_n.yasl",
+  "test/inputs/std/collections/builder.yasl",
+  "test/inputs/builtin-types/str/ascii_long.yasl",
+  "test/inputs/builtin-types/str/utf8.yasl",
+  "test/inputs/std/re.yasl",
+  "test/inputs/builtin-types/str/iter.yasl",
 };
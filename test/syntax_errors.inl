@@ -4,6 +4,7 @@ static const char *syntax_errors[] = {
   "test/errors/syntax/augmented_assign_no_r.yasl",
   "test/errors/syntax/id_colon.yasl",
   "test/errors/syntax/invalid_id.yasl",
+  "test/errors/syntax/lazy_undeclared_var.yasl",
   "test/errors/syntax/minus_no_r.yasl",
   "test/errors/syntax/reserved_id.yasl",
   "test/errors/syntax/semicolon.yasl",
@@ -1,5 +1,6 @@
 static const char *type_errors[] = {
   "test/errors/type/callable.yasl",
+  "test/errors/type/len_in_fn.yasl",
   "test/errors/type/collections/set/add2.yasl",
   "test/errors/type/collections/set/add3.yasl",
   "test/errors/type/collections/set/add.yasl",
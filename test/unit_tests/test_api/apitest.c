@@ -2,20 +2,28 @@
 #include "pushtest.h"
 #include "poptest.h"
 #include "deltest.h"
+#include "bytecodetest.h"
+#include "copytest.h"
 #include "fntest.h"
 #include "tablenexttest.h"
+#include "tablefieldtest.h"
 #include "listitertest.h"
+#include "sorttest.h"
 
 SETUP_YATS();
 
 ////////////////////////////////////////////////////////////////////////////////
 
 int apitest() {
+	RUN(bytecodetest);
+	RUN(copytest);
 	RUN(deltest);
 	RUN(fntest);
 	RUN(poptest);
 	RUN(pushtest);
 	RUN(listitertest);
+	RUN(sorttest);
 	RUN(tablenexttest);
+	RUN(tablefieldtest);
 	return NUM_FAILED;
 }
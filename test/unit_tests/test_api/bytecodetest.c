@@ -0,0 +1,95 @@
+#include "yats.h"
+#include "yasl.h"
+#include "yasl_state.h"
+
+SETUP_YATS();
+
+#define BYTECODE_FILE "bytecodetest.yaslc"
+
+static void testroundtrip(void) {
+	const char *code = "fn f(n) {\n"
+			   "    let a = 0\n"
+			   "    let b = 1\n"
+			   "    for i in [0, 1, 2, 3, 4, 5, 6, 7, 8, 9] {\n"
+			   "        if i >= n {\n"
+			   "            return a\n"
+			   "        }\n"
+			   "        b += a\n"
+			   "        a = b - a\n"
+			   "    }\n"
+			   "}\n"
+			   "const xs = [ f(i) for i in [1, 2, 3, 4, 5, 6, 7, 8] ]\n"
+			   "echo \"fibs: #{xs}, #{2.5 * 2}, #{-1000}\"\n";
+	remove(BYTECODE_FILE);
+	struct YASL_State *S = YASL_newstate_bb(code, strlen(code));
+	ASSERT_SUCCESS(YASL_savebytecode(S, BYTECODE_FILE));
+	YASL_delstate(S);
+
+	S = YASL_newstate_bytecode(BYTECODE_FILE);
+	ASSERT(S != NULL);
+	if (!S) return;
+	YASL_setprintout_tostr(S);
+	ASSERT_SUCCESS(YASL_execute(S));
+	YASL_loadprintout(S);
+	const char *expected = "fibs: [1, 1, 2, 3, 5, 8, 13, 21], 5.0, -1000\n";
+	char *actual = YASL_peekcstr(S);
+	ASSERT_STR_EQ(expected, actual, strlen(expected) + 1);
+	free(actual);
+	YASL_delstate(S);
+	remove(BYTECODE_FILE);
+}
+
+static void testsharedimage(void) {
+	const char *code = "const greeting = 'hello, ' ~ 'world'\n"
+			   "const t = { 'key': greeting, greeting: 'value' }\n"
+			   "echo t.key->toupper() ~ ' ' ~ t[greeting]\n";
+	remove(BYTECODE_FILE);
+	struct YASL_State *S = YASL_newstate_bb(code, strlen(code));
+	ASSERT_SUCCESS(YASL_savebytecode(S, BYTECODE_FILE));
+	YASL_delstate(S);
+
+	struct YASL_State *first = YASL_newstate_bytecode(BYTECODE_FILE);
+	struct YASL_State *second = YASL_newstate_bytecode(BYTECODE_FILE);
+	ASSERT(first != NULL && second != NULL);
+	if (!first || !second) return;
+	remove(BYTECODE_FILE);
+
+	const char *expected = "HELLO, WORLD value\n";
+	YASL_setprintout_tostr(first);
+	ASSERT_SUCCESS(YASL_execute(first));
+	YASL_delstate(first);
+
+	YASL_setprintout_tostr(second);
+	ASSERT_SUCCESS(YASL_execute(second));
+	YASL_loadprintout(second);
+	char *actual = YASL_peekcstr(second);
+	ASSERT_STR_EQ(expected, actual, strlen(expected) + 1);
+	free(actual);
+	YASL_delstate(second);
+}
+
+static void testsyntaxerror(void) {
+	const char *code = "echo (1 +\n";
+	remove(BYTECODE_FILE);
+	struct YASL_State *S = YASL_newstate_bb(code, strlen(code));
+	YASL_setprinterr_tostr(S);
+	ASSERT_EQ(YASL_savebytecode(S, BYTECODE_FILE), YASL_SYNTAX_ERROR);
+	YASL_delstate(S);
+	ASSERT(YASL_newstate_bytecode(BYTECODE_FILE) == NULL);
+}
+
+static void testbadfile(void) {
+	FILE *fp = fopen(BYTECODE_FILE, "wb");
+	fputs("echo 'not bytecode'\n", fp);
+	fclose(fp);
+	ASSERT(YASL_newstate_bytecode(BYTECODE_FILE) == NULL);
+	remove(BYTECODE_FILE);
+}
+
+TEST(bytecodetest) {
+	testroundtrip();
+	testsharedimage();
+	testsyntaxerror();
+	testbadfile();
+	return NUM_FAILED;
+}
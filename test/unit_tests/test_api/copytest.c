@@ -0,0 +1,64 @@
+#include "yats.h"
+#include "yasl.h"
+#include "yasl_aux.h"
+#include "yasl_state.h"
+
+SETUP_YATS();
+
+static struct YASL_State *template_new(const char *code) {
+	struct YASL_State *S = YASL_newstate_bb(code, strlen(code));
+	YASLX_decllibs(S);
+	YASL_declglobal(S, "config");
+	YASL_declglobal(S, "f");
+	return S;
+}
+
+static void testcopy(void) {
+	struct YASL_State *T = template_new("config = { 'name': 'template', 'tags': [ 'a', 'b' ] }\n"
+					    "config[0] = config\n");
+	ASSERT_SUCCESS(YASL_execute(T));
+
+	const char *code = "config.name = 'copy'\n"
+			   "config.tags->push(math.max(1, 2))\n"
+			   "echo config[0].name\n"
+			   "echo config.tags\n"
+			   "echo 'abc'->toupper()\n"
+			   "echo len collections.set(1, 2)\n"
+			   "config[0] = undef\n";
+	struct YASL_State *S = YASL_newstate_copy(T, code, strlen(code));
+	ASSERT(S != NULL);
+	if (!S) return;
+	YASL_setprintout_tostr(S);
+	ASSERT_SUCCESS(YASL_execute(S));
+	YASL_loadprintout(S);
+	const char *expected = "copy\n[a, b, 2]\nABC\n2\n";
+	char *actual = YASL_peekcstr(S);
+	ASSERT_STR_EQ(expected, actual, strlen(expected) + 1);
+	free(actual);
+	YASL_delstate(S);
+
+	// The template is left as it was.
+	ASSERT_SUCCESS(YASL_loadglobal(T, "config"));
+	ASSERT_SUCCESS(YASL_tablegetfield(T, "name"));
+	actual = YASL_peekcstr(T);
+	ASSERT_STR_EQ("template", actual, strlen("template") + 1);
+	free(actual);
+	YASL_pop(T);
+	YASL_pushint(T, 0);
+	YASL_pushundef(T);
+	ASSERT_SUCCESS(YASL_tableset(T));
+	YASL_delstate(T);
+}
+
+static void testcopyfn(void) {
+	struct YASL_State *T = template_new("f = fn() -> 1\n");
+	ASSERT_SUCCESS(YASL_execute(T));
+	ASSERT(YASL_newstate_copy(T, "", 0) == NULL);
+	YASL_delstate(T);
+}
+
+TEST(copytest) {
+	testcopy();
+	testcopyfn();
+	return NUM_FAILED;
+}
@@ -0,0 +1,54 @@
+#include "yats.h"
+#include "yasl.h"
+#include "yasl_state.h"
+
+SETUP_YATS();
+
+static const char *sort_code =
+	"let seed = 1\n"
+	"fn next() {\n"
+	"	seed = (seed * 1103515245 + 12345) % 2147483648\n"
+	"	return seed - 1073741824\n"
+	"}\n"
+	"ints = []\n"
+	"floats = []\n"
+	"strs = []\n"
+	"for let i = 0; i < 140000; i += 1 {\n"
+	"	const n = next()\n"
+	"	ints->push(n)\n"
+	"	floats->push(n / 3)\n"
+	"	strs->push(n->tostr())\n"
+	"}\n"
+	"fn is_sorted(ls) {\n"
+	"	for let i = 1; i < len ls; i += 1 {\n"
+	"		if ls[i] < ls[i - 1] {\n"
+	"			return false\n"
+	"		}\n"
+	"	}\n"
+	"	return len ls == 140000\n"
+	"}\n"
+	"ints->sort()\n"
+	"floats->sort()\n"
+	"strs->sort()\n"
+	"sorted = is_sorted(ints) && is_sorted(floats) && is_sorted(strs)\n";
+
+/// 140000 elements split between 3 threads, so that the chunks are uneven and one is left out of the first merge.
+static void testsort(unsigned num_threads) {
+	struct YASL_State *S = YASL_newstate_bb(sort_code, strlen(sort_code));
+	YASL_setnumthreads(S, num_threads);
+	ASSERT_SUCCESS(YASL_declglobal(S, "ints"));
+	ASSERT_SUCCESS(YASL_declglobal(S, "floats"));
+	ASSERT_SUCCESS(YASL_declglobal(S, "strs"));
+	ASSERT_SUCCESS(YASL_declglobal(S, "sorted"));
+	ASSERT_SUCCESS(YASL_execute(S));
+	ASSERT_SUCCESS(YASL_loadglobal(S, "sorted"));
+	ASSERT(YASL_isbool(S));
+	ASSERT(YASL_popbool(S));
+
+	YASL_delstate(S);
+}
+
+TEST(sorttest) {
+	testsort(3);
+	return NUM_FAILED;
+}
@@ -0,0 +1,66 @@
+#include "yats.h"
+#include "yasl.h"
+#include "yasl_state.h"
+
+SETUP_YATS();
+
+static void testtablefield(void) {
+	const char *code = "x = { 'a': 1, 'b': 2 };";
+	struct YASL_State *S = YASL_newstate_bb(code, strlen(code));
+	ASSERT_SUCCESS(YASL_declglobal(S, "x"));
+	ASSERT_SUCCESS(YASL_execute(S));
+	ASSERT_SUCCESS(YASL_loadglobal(S, "x"));
+
+	ASSERT_SUCCESS(YASL_tablegetfield(S, "a"));
+	ASSERT(YASL_isint(S));
+	ASSERT_EQ(YASL_popint(S), 1);
+
+	ASSERT_SUCCESS(YASL_tablegetfield(S, "c"));
+	ASSERT(YASL_isundef(S));
+	YASL_pop(S);
+
+	YASL_pushint(S, 10);
+	ASSERT_SUCCESS(YASL_tablesetfield(S, "a"));
+	YASL_pushint(S, 20);
+	ASSERT_SUCCESS(YASL_tablesetfield(S, "c"));
+	YASL_len(S);
+	ASSERT_EQ(YASL_popint(S), 3);
+
+	ASSERT_SUCCESS(YASL_loadglobal(S, "x"));
+	ASSERT_SUCCESS(YASL_tablegetfield(S, "a"));
+	ASSERT_EQ(YASL_popint(S), 10);
+	ASSERT_SUCCESS(YASL_tablegetfield(S, "c"));
+	ASSERT_EQ(YASL_popint(S), 20);
+	YASL_pop(S);
+
+	YASL_pushint(S, 4);
+	YASL_pushint(S, 5);
+	ASSERT_EQ(YASL_tablesetfield(S, "a"), YASL_TYPE_ERROR);
+	ASSERT_EQ(YASL_tablegetfield(S, "a"), YASL_TYPE_ERROR);
+
+	YASL_delstate(S);
+}
+
+static void testsetglobal(void) {
+	const char *code = "x = 1;";
+	struct YASL_State *S = YASL_newstate_bb(code, strlen(code));
+	ASSERT_SUCCESS(YASL_declglobal(S, "x"));
+	ASSERT_SUCCESS(YASL_execute(S));
+
+	YASL_pushint(S, 2);
+	ASSERT_SUCCESS(YASL_setglobal(S, "x"));
+	ASSERT_SUCCESS(YASL_loadglobal(S, "x"));
+	ASSERT_EQ(YASL_popint(S), 2);
+
+	YASL_pushint(S, 3);
+	ASSERT(YASL_setglobal(S, "y") != YASL_SUCCESS);
+	ASSERT(YASL_loadglobal(S, "y") != YASL_SUCCESS);
+
+	YASL_delstate(S);
+}
+
+TEST(tablefieldtest) {
+	testtablefield();
+	testsetglobal();
+	return NUM_FAILED;
+}
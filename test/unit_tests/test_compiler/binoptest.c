@@ -207,19 +207,37 @@ static void test_bor() {
 static void test_concat() {
 	unsigned char expected[] = {
 		0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		C_INT_1, 2,
 		C_INT_1, 1,
 		O_LIT, 0x00,
 		O_LIT, 0x01,
-		O_CNCT,
+		O_CNCT_N, 0x02,
 		O_POP,
 		O_HALT
 	};
 	ASSERT_GEN_BC_EQ(expected, "2 ~ 1;");
 }
 
+static void test_concat_chain() {
+	unsigned char expected[] = {
+		0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		C_INT_1, 3,
+		C_INT_1, 2,
+		C_INT_1, 1,
+		O_LIT, 0x00,
+		O_LIT, 0x01,
+		O_LIT, 0x02,
+		O_CNCT_N, 0x03,
+		O_POP,
+		O_HALT
+	};
+	ASSERT_GEN_BC_EQ(expected, "(3 ~ 2) ~ 1;");
+}
+
 static void test_and() {
 	unsigned char expected[] = {
 		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -268,6 +286,7 @@ TEST(binoptest) {
 	test_bxor();
 	test_bor();
 	test_concat();
+	test_concat_chain();
 	test_and();
 	test_or();
 
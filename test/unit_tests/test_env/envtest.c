@@ -5,6 +5,26 @@ SETUP_YATS();
 
 #define ENTER_SCOPE(env) do { (env)->scope = scope_new((env)->scope); } while(0)
 
+static struct SymbolTable symbols;
+
+#define SYM(name) symboltable_intern(&symbols, name, strlen(name))
+
+static void test_symbols(void) {
+	int64_t a = SYM("a");
+	int64_t b = SYM("b");
+	ASSERT(a != b);
+	ASSERT_EQ(SYM("a"), a);
+	ASSERT_EQ(symboltable_find(&symbols, "b", 1), b);
+	ASSERT_EQ(symboltable_find(&symbols, "c", 1), -1);
+	for (int i = 0; i < 1000; i++) {
+		char name[16];
+		sprintf(name, "v%d", i);
+		SYM(name);
+	}
+	ASSERT_EQ(SYM("a"), a);
+	ASSERT_EQ(SYM("v999"), symboltable_find(&symbols, "v999", 4));
+}
+
 /*
 fn f(a) {
     fn g(b) {
@@ -27,11 +47,11 @@ static void test_two(void) {
 	ENTER_SCOPE(outer);
 	ENTER_SCOPE(inner);
 
-	scope_decl_var(outer->scope, "a");
-	scope_decl_var(outer->scope, "g");
-	scope_decl_var(inner->scope, "b");
+	scope_decl_var(outer->scope, SYM("a"));
+	scope_decl_var(outer->scope, SYM("g"));
+	scope_decl_var(inner->scope, SYM("b"));
 
-	int64_t a = env_resolve_upval_index(inner, NULL, "a");
+	int64_t a = env_resolve_upval_index(inner, NULL, SYM("a"));
 	ASSERT_EQ(a, 0);
 
 	env_del(inner);
@@ -59,14 +79,14 @@ static void test_multi(void) {
 	ENTER_SCOPE(outer);
 	ENTER_SCOPE(inner);
 
-	scope_decl_var(outer->scope, "x");
-	scope_decl_var(outer->scope, "a");
-	scope_decl_var(outer->scope, "b");
-	scope_decl_var(outer->scope, "g");
-	scope_decl_var(inner->scope, "y");
+	scope_decl_var(outer->scope, SYM("x"));
+	scope_decl_var(outer->scope, SYM("a"));
+	scope_decl_var(outer->scope, SYM("b"));
+	scope_decl_var(outer->scope, SYM("g"));
+	scope_decl_var(inner->scope, SYM("y"));
 
-	int64_t a = env_resolve_upval_index(inner, NULL, "a");
-	int64_t b = env_resolve_upval_index(inner, NULL, "b");
+	int64_t a = env_resolve_upval_index(inner, NULL, SYM("a"));
+	int64_t b = env_resolve_upval_index(inner, NULL, SYM("b"));
 
 	ASSERT_EQ(a, 0);
 	ASSERT_EQ(b, 1);
@@ -96,22 +116,22 @@ static void test_multi_reversed(void) {
 	ENTER_SCOPE(outer);
 	ENTER_SCOPE(inner);
 
-	scope_decl_var(outer->scope, "x");
-	scope_decl_var(outer->scope, "a");
-	scope_decl_var(outer->scope, "b");
-	scope_decl_var(outer->scope, "g");
-	scope_decl_var(inner->scope, "y");
+	scope_decl_var(outer->scope, SYM("x"));
+	scope_decl_var(outer->scope, SYM("a"));
+	scope_decl_var(outer->scope, SYM("b"));
+	scope_decl_var(outer->scope, SYM("g"));
+	scope_decl_var(inner->scope, SYM("y"));
 
-	int64_t b = env_resolve_upval_index(inner, NULL, "b");
-	int64_t a = env_resolve_upval_index(inner, NULL, "a");
-	int64_t a_again = env_resolve_upval_index(inner, NULL, "a");
+	int64_t b = env_resolve_upval_index(inner, NULL, SYM("b"));
+	int64_t a = env_resolve_upval_index(inner, NULL, SYM("a"));
+	int64_t a_again = env_resolve_upval_index(inner, NULL, SYM("a"));
 
 	ASSERT_EQ(a, 1);
 	ASSERT_EQ(a_again, 1);
 	ASSERT_EQ(b, 0);
 
-	int64_t a_value = env_resolve_upval_value(inner, "a");
-	int64_t b_value = env_resolve_upval_value(inner, "b");
+	int64_t a_value = env_resolve_upval_value(inner, SYM("a"));
+	int64_t b_value = env_resolve_upval_value(inner, SYM("b"));
 	ASSERT_EQ(a_value, 1);
 	ASSERT_EQ(b_value, 2);
 
@@ -143,16 +163,16 @@ static void test_deep(void) {
 	ENTER_SCOPE(middle);
 	ENTER_SCOPE(inner);
 
-	scope_decl_var(outer->scope, "x");
-	scope_decl_var(outer->scope, "middle");
-	scope_decl_var(middle->scope, "inner");
-	scope_decl_var(outer->scope, "i");
+	scope_decl_var(outer->scope, SYM("x"));
+	scope_decl_var(outer->scope, SYM("middle"));
+	scope_decl_var(middle->scope, SYM("inner"));
+	scope_decl_var(outer->scope, SYM("i"));
 
-	ASSERT_EQ(env_resolve_upval_index(inner, NULL, "x"), 0);
-	ASSERT_EQ(env_resolve_upval_value(inner, "x"), ~0);
+	ASSERT_EQ(env_resolve_upval_index(inner, NULL, SYM("x")), 0);
+	ASSERT_EQ(env_resolve_upval_value(inner, SYM("x")), ~0);
 
-	ASSERT_EQ(env_resolve_upval_index(middle, NULL, "x"), 0);
-	ASSERT_EQ(env_resolve_upval_value(middle, "x"), 0);
+	ASSERT_EQ(env_resolve_upval_index(middle, NULL, SYM("x")), 0);
+	ASSERT_EQ(env_resolve_upval_value(middle, SYM("x")), 0);
 
 	env_del(inner);
 }
@@ -166,30 +186,33 @@ static void test_deep_many_vars(void) {
 	ENTER_SCOPE(middle);
 	ENTER_SCOPE(inner);
 
-	scope_decl_var(outer->scope, "x");
-	scope_decl_var(outer->scope, "y");
-	scope_decl_var(outer->scope, "z");
-	scope_decl_var(outer->scope, "middle");
-	scope_decl_var(middle->scope, "inner");
-	scope_decl_var(outer->scope, "i");
+	scope_decl_var(outer->scope, SYM("x"));
+	scope_decl_var(outer->scope, SYM("y"));
+	scope_decl_var(outer->scope, SYM("z"));
+	scope_decl_var(outer->scope, SYM("middle"));
+	scope_decl_var(middle->scope, SYM("inner"));
+	scope_decl_var(outer->scope, SYM("i"));
 
-	ASSERT_EQ(env_resolve_upval_index(middle, NULL, "y"), 0);
-	ASSERT_EQ(env_resolve_upval_value(middle, "y"), 1);
+	ASSERT_EQ(env_resolve_upval_index(middle, NULL, SYM("y")), 0);
+	ASSERT_EQ(env_resolve_upval_value(middle, SYM("y")), 1);
 
-	ASSERT_EQ(env_resolve_upval_index(inner, NULL, "z"), 0);
-	ASSERT_EQ(env_resolve_upval_value(inner, "z"), ~1);
+	ASSERT_EQ(env_resolve_upval_index(inner, NULL, SYM("z")), 0);
+	ASSERT_EQ(env_resolve_upval_value(inner, SYM("z")), ~1);
 
-	ASSERT_EQ(env_resolve_upval_index(middle, NULL, "z"), 1);
-	ASSERT_EQ(env_resolve_upval_value(middle, "z"), 2);
+	ASSERT_EQ(env_resolve_upval_index(middle, NULL, SYM("z")), 1);
+	ASSERT_EQ(env_resolve_upval_value(middle, SYM("z")), 2);
 
 	env_del(inner);
 }
 
 int envtest(void) {
+	symbols = NEW_SYMBOLTABLE();
+	test_symbols();
 	test_two();
 	test_multi();
 	test_multi_reversed();
 	test_deep();
 	test_deep_many_vars();
+	symboltable_cleanup(&symbols);
 	return NUM_FAILED;
 }
@@ -1,7 +1,11 @@
 #include "utiltest.h"
 #include "yats.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "util/varint.h"
+#include "util/yasl_float.h"
 
 SETUP_YATS();
 
@@ -12,6 +16,19 @@ SETUP_YATS();
 	ASSERT_EQ(vint_decode(buff), v);\
 }
 
+#define ASSERT_FLOAT_ROUNDTRIP(v) {\
+	char buff[YASL_FLOAT_BUFF_LEN];\
+	size_t written = float64_to_buf(buff, v);\
+	ASSERT_EQ(strlen(buff), written);\
+	ASSERT_EQ(strtod(buff, NULL), v);\
+}
+
+#define ASSERT_FLOAT_STR(v, expected) {\
+	char buff[YASL_FLOAT_BUFF_LEN];\
+	float64_to_buf(buff, v);\
+	ASSERT_STR_EQ(buff, expected, sizeof(expected));\
+}
+
 int utiltest(void) {
 	ASSERT_VINT_ROUNDTRIP(120);
 	ASSERT_VINT_ROUNDTRIP(3123);
@@ -36,5 +53,19 @@ int utiltest(void) {
 	ASSERT_EQ(vint_decode(vint_next(buff)), v2);
 	ASSERT_EQ(vint_decode(vint_next(vint_next(buff))), v3);
 
+	ASSERT_FLOAT_ROUNDTRIP(0.1);
+	ASSERT_FLOAT_ROUNDTRIP(1.0 / 3.0);
+	ASSERT_FLOAT_ROUNDTRIP(5e-324);
+	ASSERT_FLOAT_ROUNDTRIP(2.2250738585072014e-308);
+	ASSERT_FLOAT_ROUNDTRIP(1.7976931348623157e308);
+	ASSERT_FLOAT_ROUNDTRIP(-123456.789e-20);
+	ASSERT_FLOAT_ROUNDTRIP(9007199254740993.0);
+
+	ASSERT_FLOAT_STR(0.3, "0.3");
+	ASSERT_FLOAT_STR(1.0, "1.0");
+	ASSERT_FLOAT_STR(-2.5, "-2.5");
+	ASSERT_FLOAT_STR(1e21, "1.0e21");
+	ASSERT_FLOAT_STR(1.25e-10, "1.25e-10");
+
 	return NUM_FAILED;
 }
@@ -4,6 +4,7 @@
 #include "yasl_aux.h"
 #include "IO.h"
 #include "yasl_state.h"
+#include "data-structures/YASL_StringSet.h"
 
 SETUP_YATS();
 
@@ -293,6 +294,53 @@ static TEST(testaddupvalue) {
 	return NUM_FAILED;
 }
 
+static TEST(testinternedstrings) {
+	struct VM vm;
+	vm_init(&vm, NULL, 0, 1);
+
+	struct YASL_String *a = YASL_String_new_copyz(&vm, "short");
+	ASSERT(a == YASL_String_new_copyz(&vm, "short"));
+
+	const char *long_str = "a string that is too long to be interned at runtime";
+	struct YASL_String *b = YASL_String_new_copyz(&vm, long_str);
+	struct YASL_String *c = YASL_String_new_copyz(&vm, long_str);
+	ASSERT(b != c);
+	str_del(b);
+	str_del(c);
+
+	const size_t before = vm.interned_strings->count;
+	for (int i = 0; i < 10000; i++) {
+		char buffer[32];
+		snprintf(buffer, sizeof(buffer), "str%d", i);
+		vm_pushstr(&vm, YASL_String_new_copyz(&vm, buffer));
+		vm_pop(&vm);
+	}
+	vm_pushint(&vm, 0);
+	ASSERT_EQ(vm.interned_strings->count, before);
+
+	vm_cleanup(&vm);
+	return NUM_FAILED;
+}
+
+static TEST(testcharstrs) {
+	struct VM vm;
+	vm_init(&vm, NULL, 0, 1);
+
+	struct YASL_String *a = vm_char_str(&vm, 'a');
+	ASSERT(a == vm_char_str(&vm, 'a'));
+	ASSERT_EQ(YASL_String_len(a), 1);
+	ASSERT_EQ(*YASL_String_chars(a), 'a');
+
+	vm_pushchar(&vm, '\xff');
+	vm_pop(&vm);
+	vm_pushint(&vm, 0);
+	ASSERT(vm.char_strs[0xff] != NULL);
+	ASSERT_EQ((unsigned char)*YASL_String_chars(vm.char_strs[0xff]), 0xff);
+
+	vm_cleanup(&vm);
+	return NUM_FAILED;
+}
+
 int vmtest(void) {
 	RUN(testpushundef);
 	RUN(testpushbool);
@@ -307,6 +355,8 @@ int vmtest(void) {
 	RUN(testinserttop);
 	RUN(testinsertbottom);
 	RUN(testaddupvalue);
+	RUN(testinternedstrings);
+	RUN(testcharstrs);
 
 	return NUM_FAILED;
 }
@@ -1,4 +1,6 @@
 static const char *value_errors[] = {
+  "test/errors/value/bool/tostr-format.yasl",
+  "test/errors/value/int/tostr-format.yasl",
   "test/errors/value/io/open1.yasl",
   "test/errors/value/io/open2.yasl",
   "test/errors/value/io/open3.yasl",
@@ -10,6 +12,8 @@ static const char *value_errors[] = {
   "test/errors/value/list/pop.yasl",
   "test/errors/value/list/__set.yasl",
   "test/errors/value/list/sort.yasl",
+  "test/errors/value/list/sortby.yasl",
+  "test/errors/value/list/sortby_resize.yasl",
   "test/errors/value/str/__get_negative.yasl",
   "test/errors/value/str/__get.yasl",
   "test/errors/value/str/replace.yasl",
@@ -21,4 +25,10 @@ static const char *value_errors[] = {
   "test/errors/value/str/tolist.yasl",
   "test/errors/value/str/tostr-format2.yasl",
   "test/errors/value/str/tostr-format.yasl",
+  "test/errors/value/collections/deque_popleft.yasl",
+  "test/errors/value/str/ulen_invalid.yasl",
+  "test/errors/value/str/uget.yasl",
+  "test/errors/value/re/compile.yasl",
+  "test/errors/value/re/compile_groups.yasl",
+  "test/errors/value/str/splititer.yasl",
 };
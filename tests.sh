@@ -13,10 +13,12 @@ declare -i ran=0;
 read -r -d '' usage << 'EOF'
 usage: yasl [option] [input]
 options:
+	-b input [output]: compiles `input` to the bytecode file `output` (by default, `input` followed by `c`).
 	-C: checks `input` for syntax errors but doesn't run it.
 	-e input: executes `input` as code and prints result of last statement.
 	-E input: executes `input` as code.
 	-h: show this text.
+	-r input: runs the bytecode file `input`, as written by -b.
 	-V: print current version.
 	input: name of file containing script (or literal to execute with -e or -E).
 EOF
@@ -104,6 +106,12 @@ run_cli_tests () {
     run_cli_test '' '-E' 'let x = 10; x;';
     run_cli_test '10' '-E' 'let x = 10; echo x;';
     run_cli_test "$usage" '-h';
+    declare bytecode="${TMPDIR:-/tmp}/yasl_cli_test.yaslc";
+    run_cli_test '' '-b' 'test/inputs/scripts/fib.yasl' "$bytecode";
+    run_cli_test "$(<test/inputs/scripts/fib.yasl.out)" '-r' "$bytecode";
+    run_cli_test '' '-b' 'test/inputs/builtin-types/int/tostr-format.yasl' "$bytecode";
+    run_cli_test "$(<test/inputs/builtin-types/int/tostr-format.yasl.out)" '-r' "$bytecode";
+    rm -f "$bytecode";
     # run_cli_test $'A = 10\nB = 11\n[test/inputs/syntax/ifdef_simple.yasl, a, b, c]' '-DA=10' '-DB=11' '-Duse_args=true' 'test/inputs/syntax/ifdef_simple.yasl' 'a' 'b' 'c'
 }
 